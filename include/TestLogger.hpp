@@ -2,6 +2,7 @@
 
 #include "Test.hpp"
 #include "pt/logging.h"
+#include "pt/name.h"
 
 #include <iostream>
 
@@ -12,4 +13,18 @@ public:
     virtual ~TestLogger(){}
     virtual bool run() override;
     void printAsciiTable();
+    void testConcurrentLogging( size_t thread_count = 4, size_t message_count = 16 );
+    bool testBinaryLogging();
+    bool testKeyValueLogging();
+    bool testSinks();
+    bool testContainerLogging();
+    bool testCategories();
+    bool testRotation();
+    bool testTimestamps();
+    bool testOverflowPolicies();
+    bool testCrashHandler();
+    bool testDaemonRing();
+    bool testMappedFile();
+    bool testLogTool();
+    bool testLimitedLogging( size_t thread_count = 4, size_t message_count = 64 );
 };
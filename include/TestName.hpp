@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Test.hpp"
+
+#include <cstddef>
+
+class TestName: public Test
+{
+public:
+    TestName(){}
+    virtual ~TestName(){}
+    virtual bool run() override;
+
+    bool testConstruction();
+    bool testHashes();
+    bool testLiterals();
+    bool testFind();
+    bool testEmbeddedNul();
+    bool testArenaStorage();
+    bool testConcurrentInterning( size_t thread_count = 8, size_t name_count = 2000 );
+    bool testContainers();
+};
@@ -0,0 +1,159 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    backend.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Asynchronous writer backend of the logger.
+  *            Producers push formatted records into a bounded lock-free ring buffer.
+  *            One background thread drains the buffer and writes the records into the sinks
+  *            bound to their logstream (see 'sink.h'), by default "console" and "file".
+  *          The sinks are flushed at the end of every drained batch, that completed a line (if 'flushOnSend' is set),
+  *            every 'flushIntervalMs' milliseconds and in 'Stop()'.
+  *          The "file" sink is opened in 'Start()', see 'logfilesink.h' for multiprocess mode ('daemonName').
+  *          When the queue is full, producers follow the 'OverflowPolicy' of their logstream.
+  *            The writer thread reports the dropped records periodically into the "warn" stream.
+  *          While the writer thread is not running (before 'pt::log::Initialize()' or after 'pt::log::Destroy()'),
+  *            records are written synchronously on the calling thread.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/log/filesink.h"
+#include "pt/log/logfilesink.h"
+#include "pt/log/logrecord.h"
+#include "pt/log/logstream.hpp"
+#include "pt/log/ringbuffer.hpp"
+#include "pt/log/sink.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace pt{
+namespace log{
+
+class logstream;
+
+
+struct BackendSettings{
+    size_t      queueCapacity   = 8192;                         // rounded up to the next power of 2
+    size_t      fileBufferSize  = FileSink::DefaultBufferSize;  // 0: unbuffered
+    uint32_t    flushIntervalMs = 1000;                         // 0: no timed flush
+    bool        flushOnSend     = true;
+    std::string daemonName;                                     // shared memory name of the logger daemon ("": disabled)
+    uint32_t    daemonTimeoutMs = 5000;
+    RotationSettings rotation;                                  // rotation of the local log file
+    FileMode    fileMode        = FileMode::Buffered;           // implementation of the local log file
+    uint8_t     overflowSeverity     = PT_LOG_LEVEL_WARN;       // threshold of 'OverflowPolicy::DropBelowSeverity'
+    uint32_t    dropReportIntervalMs = 5000;                    // dropped records are reported this often (0: only in 'Stop()')
+};
+
+
+class Backend
+{
+public:
+    Backend();
+    virtual ~Backend();
+    Backend( const Backend& other )             = delete;
+    Backend( Backend&& source )                 = delete;
+    Backend& operator=( const Backend& other )  = delete;
+    Backend& operator=( Backend&& source )      = delete;
+
+    // opens 'file_path' (if not empty) and starts the writer thread
+    bool Start( const std::string& file_path,
+                const BackendSettings& settings = BackendSettings() );
+
+    // writes out every pending record, flushes the sinks and closes the file, then joins the writer thread
+    void Stop();
+
+    bool IsRunning() const;
+    bool IsConnectedToDaemon() const;
+
+    // thread-safe
+    //   blocks only while the queue is full
+    void Submit( LogRecord&& record );
+
+    //-----
+    // sink registry (thread-safe)
+
+    // returns false, if 'name' is already taken
+    bool                    RegisterSink( const std::string& name, std::shared_ptr<Sink> sink );
+    std::shared_ptr<Sink>   FindSink( const std::string& name ) const;
+    void                    BindSinks( const logstream& stream, const SinkList& sinks );
+    void                    ResetSinks( const logstream& stream );
+
+    // async-signal-safe, the writer thread calls 'pt::log::LoadSettings()' at its next wake-up
+    static void RequestSettingsReload();
+
+    //-----
+    // emergency path of the crash handler (async-signal-safe, see 'crashhandler.h')
+
+    // writes out the file buffer, then 'header' and the records waiting in the queue
+    //   through the "file" sink, bypassing the writer thread
+    void EmergencyFlush( const char* header, size_t header_length );
+    int  GetEmergencyDescriptor();
+
+private:
+    using SinkBindings = std::unordered_map< const logstream*, std::shared_ptr<const SinkList> >;
+
+    bool IsDroppable_( const logstream& stream ) const;
+    void CountDrop_( const logstream& stream );
+    // consumes one of the producers' requests to drop a record (see 'OverflowPolicy::DropOldest')
+    bool TakeDropRequest_();
+    void ReportDrops_();
+    void WriterLoop_();
+    void WakeWriter_();
+    void WriteRecordDirect_( LogRecord& record );
+    void DecodeRecord_( LogRecord& record, std::string& scratch );
+    void RefreshWriterBindings_();
+    const SinkList& GetWriterSinks_( const logstream* stream ) const;
+    void MarkDirty_( const std::shared_ptr<Sink>& sink );
+    void FlushDirtySinks_();
+
+    BackendSettings         mSettings;
+    std::unique_ptr< RingBuffer<LogRecord> > mQueue;
+    std::thread             mWriter;
+    std::string             mDecodeScratch;     // reused formatting buffer of the writer thread
+
+    std::shared_ptr<LogFileSink>        mLogFileSink;
+    std::shared_ptr<const SinkList>     mDefaultSinks;
+
+    mutable std::mutex                  mSinkMutex;         // guards the registry and the bindings
+    std::map< std::string, std::shared_ptr<Sink> > mSinkRegistry;
+    SinkBindings                        mSinkBindings;
+    std::atomic<uint64_t>               mSinkGeneration;    // incremented on every binding change
+
+    // the writer thread's copy of the bindings, refreshed when 'mSinkGeneration' changes
+    SinkBindings            mWriterBindings;
+    uint64_t                mWriterGeneration = 0;
+    SinkList                mDirtySinks;        // written since their last flush
+
+    std::mutex                      mDropMutex;
+    std::vector<const logstream*>   mDropReports;   // streams with drops since the last report
+
+    static std::atomic<bool> smSettingsReloadRequested;
+
+    std::atomic<bool>       mRunning;
+    std::atomic<bool>       mStopRequested;
+    std::atomic<bool>       mWriterSleeping;
+    std::atomic<uint32_t>   mActiveProducers;   // producers currently between the 'mRunning' check and the push
+    std::atomic<uint32_t>   mDropRequests;      // droppable records the writer skips, instead of writing them
+
+    std::mutex              mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::mutex              mDirectMutex;       // serializes synchronous writes and the start/stop of the writer thread
+};
+
+
+Backend& GetBackend();
+
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,220 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    binrecord.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Deferred-formatting (binary) log records.
+  *            The calling thread only captures the id of a static format site
+  *            and the raw bytes of the arguments (no iostream formatting).
+  *            The text is produced later by the writer thread of the backend.
+  *          Format strings use '{}' as placeholders for the arguments in order,
+  *            extra arguments are appended at the end, separated by spaces.
+  *          Supported arguments:
+  *            bool, character and integer types, floating-point types (stored as double),
+  *            'const char*', 'std::string' (copied), 'pt::Name' (only its id is stored), 'const void*'
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace pt{
+
+class Name;
+
+namespace log{
+
+struct FormatSite{
+    const char* format  = "";
+    const char* file    = "";
+    int         line    = 0;
+};
+
+// thread-safe, 'format' and 'file' have to have static lifetime (string literals)
+//   the returned id is used in every record of the site
+uint32_t RegisterFormatSite( const char* format, const char* file, int line );
+bool     GetFormatSite( uint32_t site_id, FormatSite& site );
+
+// decodes 'payload' of a binary record and appends the formatted line to 'out'
+void     FormatBinaryRecord( const std::string& payload, std::string& out );
+
+
+namespace binary{
+
+enum class ArgType: uint8_t{
+    Bool    = 0,
+    Char    = 1,
+    Int     = 2,
+    UInt    = 3,
+    Float   = 4,
+    String  = 5,
+    Name    = 6,
+    Pointer = 7,
+};
+
+template<typename T>
+inline void
+Put( std::string& buffer, ArgType type, const T& value )
+{
+    buffer.push_back( static_cast<char>( type ) );
+    buffer.append( reinterpret_cast<const char*>( &value ), sizeof(T) );
+}
+
+inline void
+EncodeSite( std::string& buffer, uint32_t site_id )
+{
+    buffer.append( reinterpret_cast<const char*>( &site_id ), sizeof(site_id) );
+}
+
+inline void
+EncodeArg( std::string& buffer, bool value )
+{
+    Put( buffer, ArgType::Bool, static_cast<uint8_t>( value ) );
+}
+
+inline void
+EncodeArg( std::string& buffer, char value )
+{
+    Put( buffer, ArgType::Char, value );
+}
+
+inline void
+EncodeArg( std::string& buffer, signed char value )
+{
+    Put( buffer, ArgType::Char, static_cast<char>( value ) );
+}
+
+inline void
+EncodeArg( std::string& buffer, unsigned char value )
+{
+    Put( buffer, ArgType::Char, static_cast<char>( value ) );
+}
+
+template<typename T>
+inline typename std::enable_if< std::is_integral<T>::value && std::is_signed<T>::value >::type
+EncodeArg( std::string& buffer, T value )
+{
+    Put( buffer, ArgType::Int, static_cast<int64_t>( value ) );
+}
+
+template<typename T>
+inline typename std::enable_if< std::is_integral<T>::value && std::is_unsigned<T>::value >::type
+EncodeArg( std::string& buffer, T value )
+{
+    Put( buffer, ArgType::UInt, static_cast<uint64_t>( value ) );
+}
+
+template<typename T>
+inline typename std::enable_if< std::is_floating_point<T>::value >::type
+EncodeArg( std::string& buffer, T value )
+{
+    Put( buffer, ArgType::Float, static_cast<double>( value ) );
+}
+
+inline void
+EncodeString( std::string& buffer, const char* str, uint32_t length )
+{
+    Put( buffer, ArgType::String, length );
+    buffer.append( str, length );
+}
+
+inline void
+EncodeArg( std::string& buffer, const char* value )
+{
+    if( nullptr == value ){
+        value = "(null)";
+    }
+    EncodeString( buffer, value, strlen( value ) );
+}
+
+inline void
+EncodeArg( std::string& buffer, const std::string& value )
+{
+    EncodeString( buffer, value.data(), value.length() );
+}
+
+inline void
+EncodeArg( std::string& buffer, const void* value )
+{
+    Put( buffer, ArgType::Pointer, reinterpret_cast<uintptr_t>( value ) );
+}
+
+void EncodeArg( std::string& buffer, const pt::Name& value );
+
+template<typename... Args>
+inline void
+EncodeArgs( std::string& buffer, const Args&... args )
+{
+    // expands to one 'EncodeArg()' call for each argument, in order
+    int expander[] = { 0, ( EncodeArg( buffer, args ), 0 )... };
+    (void) expander;
+}
+
+
+//-----
+// decoding (writer side)
+
+class PayloadReader
+{
+public:
+    explicit PayloadReader( const std::string& payload ):
+        mData( payload.data() ), mRemaining( payload.length() )
+    {}
+
+    template<typename T>
+    bool Read( T& value ){
+        if( mRemaining < sizeof(T) ){
+            return false;
+        }
+        memcpy( &value, mData, sizeof(T) );
+        mData      += sizeof(T);
+        mRemaining -= sizeof(T);
+        return true;
+    }
+
+    bool ReadBytes( std::string& out, size_t length ){
+        if( mRemaining < length ){
+            return false;
+        }
+        out.append( mData, length );
+        mData      += length;
+        mRemaining -= length;
+        return true;
+    }
+
+    bool IsEmpty() const{
+        return 0 == mRemaining;
+    }
+
+private:
+    const char* mData;
+    size_t      mRemaining;
+};
+
+struct ArgValue{
+    ArgType     type = ArgType::Int;
+    union{
+        bool        boolValue;
+        char        charValue;
+        int64_t     intValue;
+        uint64_t    uintValue;
+        double      floatValue;
+        uintptr_t   pointerValue;
+    };
+    std::string text;           // contents of 'String' and 'Name' arguments
+
+    ArgValue(): intValue( 0 ){}
+};
+
+// reads the next argument, returns false on malformed payload
+bool ReadArg( PayloadReader& reader, ArgValue& value );
+// appends 'value' like 'operator<<' would
+void AppendArgText( const ArgValue& value, std::string& out );
+
+} //end of namespace 'binary'
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
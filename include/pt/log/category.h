@@ -0,0 +1,63 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    category.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Named logging categories (subsystems), that can be switched on and off at runtime.
+  *            Every category owns a bit of a global atomic mask, so checking one
+  *            costs a single relaxed load (see the 'PT_LOG_CAT_*' macros in 'pt/logging.h').
+  *          At most 'MaxCount' categories exist, further names share the last bit.
+  *          Categories are enabled by default, the settings file can change them
+  *            (see 'pt::log::SetSettingsFile()').
+  *          Prefer function-local static instances (the macros do that).
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/name.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace pt{
+namespace log{
+
+class Category
+{
+public:
+    static const size_t MaxCount = 64;
+
+    // registers 'name' at the first use, later instances refer to the same category
+    explicit Category( const pt::Name& name );
+    Category( const Category& other )               = default;
+    Category& operator=( const Category& other )    = default;
+    virtual ~Category();
+
+    bool IsEnabled() const{
+        return 0 != ( smEnabledMask.load( std::memory_order_relaxed ) & mBit );
+    }
+
+    void SetEnabled( bool enabled ) const;
+
+    const pt::Name& GetName() const{
+        return mName;
+    }
+
+    static void SetAllEnabled( bool enabled );
+    static std::vector<pt::Name> GetRegisteredNames();
+
+private:
+    static std::atomic<uint64_t> smEnabledMask;
+
+    pt::Name    mName;
+    uint64_t    mBit;
+};
+
+
+// shorthands, 'name' is registered, if it is not yet
+void SetCategoryEnabled( const pt::Name& name, bool enabled );
+bool IsCategoryEnabled( const pt::Name& name );
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,37 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    compress.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Built-in lightweight compressor for rotated log files (no external dependencies).
+  *          LZ77-style byte-oriented format (similar to LZ4): literal runs and back-references
+  *            into the previous 64KB, hash-based match finding, no entropy coding.
+  *            Trades ratio for speed, repetitive log text typically shrinks to a fifth of its size.
+  *          Stream layout:
+  *            "PTLZ" <version:1>, then blocks of <raw_size:4> <stored_size:4> <data>,
+  *            terminated by a block with a raw_size of 0
+  *            (the highest bit of 'stored_size' marks uncompressed blocks)
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace pt{
+namespace log{
+
+// extension appended to the name of compressed files
+extern const char* const CompressedFileExtension;
+
+// appends a complete compressed stream of 'data' to 'out'
+void Compress( const char* data, size_t length, std::string& out );
+// appends the decompressed contents to 'out', returns false on malformed input
+bool Decompress( const char* data, size_t length, std::string& out );
+
+// 'dst_path' is overwritten, 'src_path' is kept
+bool CompressFile( const std::string& src_path, const std::string& dst_path );
+bool DecompressFile( const std::string& src_path, const std::string& dst_path );
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
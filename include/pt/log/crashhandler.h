@@ -0,0 +1,34 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    crashhandler.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Emergency output of the logger on fatal signals (SIGSEGV, SIGABRT, SIGBUS).
+  *            The handler writes the buffered part of the log file, the records still waiting
+  *            in the queue of the writer thread and a stack trace into the log file,
+  *            using only async-signal-safe calls (raw 'write()', no allocation, no locks).
+  *            Then it hands the signal over to the previously installed handler (or the default one).
+  *          Best-effort: records being written by the writer thread at the time of the crash
+  *            may appear twice or be cut, queued binary and key-value records are not decoded.
+  *          Pending records are written into the log file (or the daemon's ring) regardless of their sink bindings.
+  *          The alternate signal stack (needed for stack overflows) is set up for the installing thread only.
+  *          Linux-only, installing fails on other platforms.
+  *          Installed by 'pt::log::Initialize()' by default, see 'pt::log::SetCrashHandler()'.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <cstddef>
+
+namespace pt{
+namespace log{
+
+bool InstallCrashHandler();
+void UninstallCrashHandler();
+bool IsCrashHandlerInstalled();
+
+// async-signal-safe, writes the whole 'data' into 'fd' (retries interrupted and partial writes)
+void EmergencyWrite( int fd, const char* data, size_t length );
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
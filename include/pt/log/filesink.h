@@ -0,0 +1,88 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    filesink.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Log file output with a persistent file handle and a userspace buffer.
+  *            The file is opened once and kept open until 'Close()'.
+  *            Writes only copy into the buffer, the buffer is written out
+  *              - when it would overflow
+  *              - on explicit 'Flush()' calls
+  *              - on 'Close()' and destruction
+  *          Optionally rotates the file by size and/or wall-clock interval (see 'rotation.h').
+  *            Rotation only happens at line boundaries.
+  *          Can be bound to logstreams as a sink (records are written as "<timestamp> <prefix>: <text>").
+  *          Not thread-safe, the owner has to serialize access.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/log/rotation.h"
+#include "pt/log/sink.h"
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+namespace pt{
+namespace log{
+
+class FileSink: public Sink
+{
+public:
+    static const size_t DefaultBufferSize = 64 * 1024;
+
+    FileSink();
+    virtual ~FileSink();
+    FileSink( const FileSink& other )               = delete;
+    FileSink( FileSink&& source )                   = delete;
+    FileSink& operator=( const FileSink& other )    = delete;
+    FileSink& operator=( FileSink&& source )        = delete;
+
+    // opens 'path' for appending, creates it if missing
+    //   'buffer_size' of 0 disables buffering (every 'Write()' is a syscall)
+    bool Open( const std::string& path, size_t buffer_size = DefaultBufferSize );
+    void Close();
+    bool IsOpen() const;
+
+    // takes effect immediately, also for the currently open file
+    void SetRotation( const RotationSettings& settings );
+    const RotationSettings& GetRotation() const;
+
+    void Write( const char* data, size_t length );
+    void Write( const std::string& str );
+    void Write( const LogRecord& record ) override;
+    void Flush() override;
+
+    size_t GetBufferSize() const;
+    size_t GetBufferedBytes() const;
+    const std::string& GetPath() const;
+
+    // async-signal-safe, for the crash handler (see 'crashhandler.h')
+    //   writes out the buffer without changing the state of the sink
+    void EmergencyFlush() const;
+    // -1 if closed
+    int  GetFileDescriptor() const;
+
+private:
+    void WriteToFile_( const char* data, size_t length );
+    bool IsRotationDue_( size_t incoming_length ) const;
+    void Rotate_();
+    void ScheduleNextRotation_();
+
+    int                 mFileDescriptor = -1;
+    std::string         mPath;
+    std::vector<char>   mBuffer;
+    size_t              mBufferUsed = 0;
+
+    RotationSettings    mRotation;
+    uint64_t            mFileSize = 0;
+    int64_t             mNextRotationTime = 0;      // in seconds since epoch
+    uint64_t            mNextRotationIndex = 1;
+    bool                mAtLineStart = true;
+    std::string         mHeaderScratch;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,132 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    kvrecord.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Structured (key-value) log records, see 'PT_LOG_KV()'.
+  *          Keys are interned into 'pt::Name'-s once per call site, when the site is registered,
+  *            records only carry the site id, the format and the raw bytes of the values (see 'binrecord.h').
+  *          The writer thread encodes the records in the selected format:
+  *            - Json:   one JSON object per line, that also holds the time and the stream prefix
+  *                      eg.: {"time":"2026-10-18 07:05:27.123","stream":"Log","event":"cache_miss","key":42}
+  *            - Logfmt: 'key=value' pairs after the usual line header
+  *                      eg.: 2026-10-18 07:05:27.123 Log: event=cache_miss key=42
+  *          Keys have to be the same at every call of a site (string literals or 'pt::Name'-s).
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/name.h"
+#include "pt/log/binrecord.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pt{
+namespace log{
+
+enum class KeyValueFormat: uint8_t{
+    Json    = 0,
+    Logfmt  = 1,
+};
+
+struct KeyValueSite{
+    const char*             file = "";
+    int                     line = 0;
+    std::vector<pt::Name>   keys;
+};
+
+// thread-safe, can be changed at any time (default: Json)
+//   records are formatted in the format, that was set when they were logged
+void            SetKeyValueFormat( KeyValueFormat format );
+KeyValueFormat  GetKeyValueFormat();
+
+// thread-safe, registered sites are never removed
+uint32_t            RegisterKeyValueSite( const char* file, int line, std::vector<pt::Name>&& keys );
+const KeyValueSite* GetKeyValueSite( uint32_t site_id );
+
+// decodes 'payload' and appends the line in the format stored in it to 'out'
+//   'timestamp' and 'prefix' are only used by the Json format
+//   returns the format
+KeyValueFormat FormatKeyValueRecord( const std::string& payload, int64_t timestamp,
+                                     const std::string& prefix, std::string& out );
+
+
+namespace binary{
+
+inline void
+CollectKeys( std::vector<pt::Name>& keys )
+{}
+
+// declared ahead, both key types can follow each other
+template<typename Value, typename... Rest>
+void CollectKeys( std::vector<pt::Name>& keys, const char* key, const Value& value, const Rest&... rest );
+template<typename Value, typename... Rest>
+void CollectKeys( std::vector<pt::Name>& keys, const pt::Name& key, const Value& value, const Rest&... rest );
+
+template<typename Value, typename... Rest>
+inline void
+CollectKeys( std::vector<pt::Name>& keys, const char* key, const Value& value, const Rest&... rest )
+{
+    keys.push_back( pt::Name( key ) );
+    CollectKeys( keys, rest... );
+}
+
+template<typename Value, typename... Rest>
+inline void
+CollectKeys( std::vector<pt::Name>& keys, const pt::Name& key, const Value& value, const Rest&... rest )
+{
+    keys.push_back( key );
+    CollectKeys( keys, rest... );
+}
+
+inline void
+EncodeValues( std::string& buffer )
+{}
+
+// only the values are encoded, the keys are stored in the site
+template<typename Key, typename Value, typename... Rest>
+inline void
+EncodeValues( std::string& buffer, const Key& key, const Value& value, const Rest&... rest )
+{
+    EncodeArg( buffer, value );
+    EncodeValues( buffer, rest... );
+}
+
+} //end of namespace 'binary'
+
+
+template<typename... Args>
+inline uint32_t
+RegisterKeyValueSite( const char* file, int line, const Args&... args )
+{
+    static_assert( 0 == sizeof...(Args) % 2, "key-value logging expects key-value pairs" );
+    std::vector<pt::Name> keys;
+    keys.reserve( sizeof...(Args) / 2 );
+    binary::CollectKeys( keys, args... );
+    return RegisterKeyValueSite( file, line, std::move( keys ) );
+}
+
+
+// the site of a 'PT_LOG_KV()' call, registered at its first call
+//   from the already evaluated arguments, so the values aren't evaluated a second time
+class KeyValueCallSite
+{
+public:
+    template<typename... Args>
+    uint32_t Get( const char* file, int line, const Args&... args ){
+        std::call_once( mRegistered, [&](){
+            mSiteId = RegisterKeyValueSite( file, line, args... );
+        } );
+        return mSiteId;
+    }
+
+private:
+    std::once_flag  mRegistered;
+    uint32_t        mSiteId = 0;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
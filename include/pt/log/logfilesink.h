@@ -0,0 +1,85 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    logfilesink.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: The built-in "file" sink: the log file set in 'pt::log::Initialize()'.
+  *          The local log file is written either through a userspace buffer ('FileSink')
+  *            or through a memory mapping ('MappedFileSink'), see 'FileMode'.
+  *            Rotation is only supported with 'FileMode::Buffered'.
+  *          In multiprocess mode, records are sent to the logger daemon through shared memory instead.
+  *            The local log file is only used, if the daemon can't be reached within the timeout,
+  *            it stops responding for that long, or its ring is full.
+  *          While closed (before 'Initialize()' or after 'Destroy()'), every record
+  *            is appended to the log file unbuffered, if there is one.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/log/filesink.h"
+#include "pt/log/mappedfilesink.h"
+#include "pt/log/shmring.h"
+#include "pt/log/sink.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace pt{
+namespace log{
+
+class LogFileSink: public Sink
+{
+public:
+    LogFileSink();
+    virtual ~LogFileSink();
+
+    // connects to the daemon 'daemon_name' first (if not empty)
+    //   'path' is opened only if that fails
+    bool Open( const std::string& path,
+               size_t buffer_size,
+               const std::string& daemon_name,
+               uint32_t daemon_timeout_ms,
+               const RotationSettings& rotation = RotationSettings(),
+               FileMode file_mode = FileMode::Buffered );
+    void Close();
+    bool IsOpen() const;
+    bool IsConnectedToDaemon() const;
+
+    void Write( const LogRecord& record ) override;
+    // also wakes the daemon and checks, whether it is still alive
+    void Flush() override;
+
+    // async-signal-safe, for the crash handler (see 'crashhandler.h')
+    //   writes out the file buffer
+    void EmergencyFlush();
+    //   sends 'data' to the daemon, or writes it unbuffered into the local log file or to stderr
+    void EmergencyWrite( const char* data, size_t length );
+    //   the descriptor of the local log file positioned at its end, -1 if it is not open
+    int  GetEmergencyDescriptor();
+
+private:
+    bool WriteToDaemon_( const LogRecord& record );
+    void WriteUnopened_( const LogRecord& record );
+    void CheckDaemon_();
+    bool EnsureLocalFile_();
+
+    bool                mOpen = false;
+    std::string         mPath;
+    size_t              mBufferSize = FileSink::DefaultBufferSize;
+    FileMode            mFileMode = FileMode::Buffered;
+    std::string         mDaemonName;
+    uint32_t            mDaemonTimeoutMs = 0;
+
+    FileSink            mFile;
+    MappedFileSink      mMappedFile;
+    SharedMemoryRing    mDaemonRing;
+    std::atomic<bool>   mDaemonConnected;
+    bool                mDaemonNotifyPending = false;
+    std::chrono::steady_clock::time_point mLastDaemonCheck;
+    std::string         mScratch;           // reused assembly buffer of daemon records
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,42 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    logrecord.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: A single log record, as it travels from the producer thread to the sinks.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/log/timestamp.h"
+
+#include <cstdint>
+#include <string>
+
+namespace pt{
+namespace log{
+
+class logstream;
+
+enum class RecordType: uint8_t{
+    Text    = 0,
+    Binary  = 1,    // 'text' holds an encoded payload (see 'binrecord.h'), formatted by the writer thread
+    KeyValue= 2,    // 'text' holds an encoded key-value payload (see 'kvrecord.h'), formatted by the writer thread
+    Json    = 3,    // formatted key-value record, a complete JSON line (written without line header)
+};
+
+struct LogRecord{
+    const logstream*    stream = nullptr;
+    std::string         text;
+    RecordType          type = RecordType::Text;
+    int64_t             timestamp = 0;      // see 'GetTimestamp()'
+
+    LogRecord() = default;
+    // captures the current time
+    LogRecord( const logstream* stream_, std::string&& text_, RecordType type_ = RecordType::Text ):
+        stream( stream_ ), text( std::move( text_ ) ), type( type_ ), timestamp( GetTimestamp() )
+    {}
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -7,12 +7,20 @@
  * -------------------------------------------------------------------------
  */
 
-//  TODO: make it actually multiprocess !
-
 #pragma once
 
 #include "pt/def.h"
 #include "pt/utility.hpp"
+#include "pt/log/binrecord.h"
+#include "pt/log/kvrecord.h"
+#include "pt/log/logrecord.h"
+#include "pt/log/messagebuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
 
 #include <iostream>
 #include <fstream>
@@ -36,11 +44,48 @@ class Name;
 namespace log{
 
 
+// Log levels (severities of the logstreams)
+#define PT_LOG_LEVEL_DEBUG  0
+#define PT_LOG_LEVEL_INFO   1
+#define PT_LOG_LEVEL_WARN   2
+#define PT_LOG_LEVEL_ERR    3
+#define PT_LOG_LEVEL_NONE   4
+
+
 class logstream;
 
+// marks the end of a log record (see 'pt::log::send')
+struct SendToken{};
+
+// behaviour of the stream's producers, when the queue of the backend is full
+//   dropped records are counted and reported into the log periodically (see 'pt::log::SetDropReportInterval()')
+enum class OverflowPolicy: uint8_t{
+    Block               = 0,    // wait until there is room, records are never dropped
+    DropNewest          = 1,    // drop the record being logged
+    DropOldest          = 2,    // the writer drops the oldest queued record, that its own stream allows dropping,
+                                //   instead of writing it (waits like 'Block', until the writer makes room)
+    DropBelowSeverity   = 3,    // drop the record early (at half-full queue), if the stream's severity is below
+                                //   the threshold (see 'pt::log::SetOverflowSeverity()'), block otherwise
+};
+
+// non-owning view of 'count' consecutive elements, logged like a container
+//   eg.: pt::log::out << pt::log::MakeSpan( values, count );
+template<class T>
+struct Span{
+    const T*    data;
+    size_t      count;
+};
+
+template<class T>
+inline Span<T>
+MakeSpan( const T* data, size_t count )
+{
+    return Span<T>{ data, count };
+}
+
 #define DEFINE_LOGSTREAM_OUT_OPERATOR(STREAM_OUT_VAR_1)	\
     logstream& operator<<(STREAM_OUT_VAR_1 data){	\
-        if( mEnabled ){ \
+        if( isEnabled() ){ \
             LogMessage<STREAM_OUT_VAR_1>(data); \
         } \
         return *this; \
@@ -48,7 +93,7 @@ class logstream;
 
 #define DEFINE_LOGSTREAM_OUT_FUNC_OPERATOR(STREAM_OUT_VAR_1, FUNC_PARAMS)	\
     logstream& operator<<(STREAM_OUT_VAR_1 (*data) FUNC_PARAMS){	\
-        if( mEnabled ){ \
+        if( isEnabled() ){ \
             LogMessage<STREAM_OUT_VAR_1 FUNC_PARAMS>(data); \
         } \
         return *this; \
@@ -56,113 +101,151 @@ class logstream;
 
 
 class logstream{
-    bool            mEnabled;
-    std::string     mMessagePrefix;
-
-    //TODO: make 'LogMessage' compatible with 'ostringstream::rdbuf()' as parameter
-    //  eg.: std::ostringstream oss;
-    //       pt::log::out << oss.rdbuf();
+    static std::atomic<uint32_t> smNextIndex;
+    static std::atomic<size_t>   smMaxElements;
 
-    #ifdef PT_PLATFORM_LINUX
+    std::atomic<bool> mEnabled;     // read with a relaxed load on every call
+    std::string     mMessagePrefix;
+    const uint32_t  mIndex;         // identifies the per-thread message buffers of this instance
+    const uint8_t   mSeverity;      // PT_LOG_LEVEL_*
+    std::atomic<OverflowPolicy>     mOverflowPolicy;
+    mutable std::atomic<uint64_t>   mDroppedSinceReport;
+    mutable std::atomic<uint64_t>   mDroppedTotal;
+
+    // fragments are collected in the calling thread's own buffer of this logstream
+    //   the buffer is committed as one record, when 'pt::log::send' arrives or a fragment ends the line
     template<typename T>
-    void LogMessageLinux( const T data ) const{
-        //temporary solution
-        //TODO: enqueue the message in the logger process instead
-
-        //TODO: take care of race conditions between debug/out/warn/err
-
-        //TODO: by default, fill a buffer only
-        //      when 'pt::log::send' is received, send the message to the logger process
-        std::string fname = this->getFileName();
+    void LogMessage( const T data ) const{
+        MessageBuffer& buffer = getMessageBuffer();
+        buffer.Stream() << data;
+        if( buffer.EndsLine() ){
+            commit( buffer );
+        }
+    }
 
-        if( mEnabled ){
-            std::cout << data;
+    // formats "[e1, e2, ...]" into the message buffer, at most 'smMaxElements' of them
+    template<class Iterator>
+    void LogElements( Iterator it, size_t count ) const{
+        MessageBuffer& buffer = getMessageBuffer();
+        std::ostream&  stream = buffer.Stream();
+        const size_t   shown  = std::min( count, smMaxElements.load( std::memory_order_relaxed ) );
+        stream << "[";
+        for( size_t i=0; i<shown; ++i, ++it ){
+            if( 0 < i ){
+                stream << ", ";
+            }
+            stream << *it;
         }
+        if( shown < count ){
+            stream << ( (0 < shown) ? ", " : "" ) << "...and " << ( count - shown ) << " more";
+        }
+        stream << "]";
+        if( buffer.EndsLine() ){
+            commit( buffer );
+        }
+    }
 
-        if( (mEnabled) && (fname.length() != 0) ){
-            std::fstream fs;
-            fs.open( fname.c_str(), std::fstream::out
-                                  | std::fstream::app);
+    MessageBuffer& getMessageBuffer() const;
+    void commit( MessageBuffer& buffer ) const;
+    void commitBinary( std::string&& payload, RecordType type ) const;
 
-            if(!fs.is_open()){
-                std::cout << "fs is NOT open!\n";
-            }
+    const std::string& getFileName() const;
 
-            if( 0 < mMessagePrefix.length() ){
-                fs << mMessagePrefix << ": " << data;
-            }else{
-                fs << data;
-            }
+public:
+    logstream();
+    logstream( const std::string& prefix,
+               uint8_t severity = PT_LOG_LEVEL_INFO,
+               OverflowPolicy policy = OverflowPolicy::Block );
+    virtual ~logstream(){}
+    logstream(const logstream& other)=delete;
+    logstream(logstream&& source)=delete;
 
-            fs.close();
-        }
+    logstream& operator=(const logstream& other)=delete;
+    logstream& operator=(logstream&& source)=delete;
+
+    // containers are logged with at most this many elements, followed by "...and N more"
+    static void setMaxElements( size_t count ){
+        smMaxElements.store( count, std::memory_order_relaxed );
     }
-    #elif defined PT_PLATFORM_WINDOWS
-    template<typename T>
-    void LogMessageWin( const T data ) const{
-//test code for handling Unicode paths
-//  MinGW 8.1.0's buggy with c++17 'std::filesystem', need new compiler for this
-/*
-            //std::filesystem::path p = fnameW;
-            pt::cpp::fs::path p = L"árvíztűrő tükörfúrógép/asd.txt";
-            //pt::cpp::fs::path p = fnameW.c_str();
 
-            std::fstream fs;
-            fs.open(p, std::fstream::out
-                        | std::fstream::app);
+    static size_t getMaxElements(){
+        return smMaxElements.load( std::memory_order_relaxed );
+    }
 
-            if(!fs.is_open()){
-                std::cout << "fs wchar is NOT open!\n";
-            }
+    // can be changed at any time, from any thread (eg.: by a settings reload, see 'pt::log::LoadSettings()')
+    void setEnabled(bool val){
+        mEnabled.store( val, std::memory_order_relaxed );
+    }
 
-            fs << data;
+    bool isEnabled() const{
+        return mEnabled.load( std::memory_order_relaxed );
+    }
 
-            fs.close();
-*/
+    const std::string& getPrefix() const{
+        return mMessagePrefix;
+    }
 
-            std::cout << data;
-/*
-            std::string fname = this->getFileName();
-            std::string path = fname;
-            std::fstream fs;
-            fs.open(path, std::fstream::out
-                        | std::fstream::app);
-
-            if(!fs.is_open()){
-                std::cout << "fs char is NOT open!\n";
-            }
+    uint8_t getSeverity() const{
+        return mSeverity;
+    }
 
-            fs << data;
+    void setOverflowPolicy( OverflowPolicy policy ){
+        mOverflowPolicy.store( policy, std::memory_order_relaxed );
+    }
 
-            fs.close();
-*/
+    OverflowPolicy getOverflowPolicy() const{
+        return mOverflowPolicy.load( std::memory_order_relaxed );
     }
-    #endif
 
+    // dropped records since construction
+    uint64_t getDroppedCount() const{
+        return mDroppedTotal.load( std::memory_order_relaxed );
+    }
 
-    template<typename T>
-    void LogMessage( const T data ) const{
-        #ifdef PT_PLATFORM_LINUX
-        LogMessageLinux<T>(data);
-        #elif defined PT_PLATFORM_WINDOWS
-        LogMessageWin<T>(data);
-        #endif
+    // used by the backend
+    //   'countDrop()' returns true for the first drop since the last 'takeDropsSinceReport()'
+    bool countDrop() const{
+        mDroppedTotal.fetch_add( 1, std::memory_order_relaxed );
+        return 0 == mDroppedSinceReport.fetch_add( 1, std::memory_order_relaxed );
     }
 
-    const std::string& getFileName() const;
+    uint64_t takeDropsSinceReport() const{
+        return mDroppedSinceReport.exchange( 0, std::memory_order_relaxed );
+    }
 
-public:
-    logstream();
-    logstream( const std::string& prefix );
-    virtual ~logstream(){}
-    logstream(const logstream& other)=delete;
-    logstream(logstream&& source)=delete;
+    // deferred-formatting record (see 'binrecord.h' and 'PT_LOG_BINARY_*' macros)
+    //   only the site id and the raw argument bytes are captured here
+    template<typename... Args>
+    void logBinary( uint32_t site_id, const Args&... args ){
+        if( isEnabled() ){
+            std::string payload;
+            payload.reserve( sizeof(site_id) + 16 * sizeof...(Args) );
+            binary::EncodeSite( payload, site_id );
+            binary::EncodeArgs( payload, args... );
+            commitBinary( std::move( payload ), RecordType::Binary );
+        }
+    }
 
-    logstream& operator=(const logstream& other)=delete;
-    logstream& operator=(logstream&& source)=delete;
+    // structured record (see 'kvrecord.h' and 'PT_LOG_KV' macro)
+    //   'args' are key-value pairs, only the values are captured here
+    template<typename... Args>
+    void logKeyValues( uint32_t site_id, const Args&... args ){
+        if( isEnabled() ){
+            std::string payload;
+            payload.reserve( sizeof(site_id) + 8 * sizeof...(Args) );
+            binary::EncodeSite( payload, site_id );
+            payload.push_back( static_cast<char>( GetKeyValueFormat() ) );
+            binary::EncodeValues( payload, args... );
+            commitBinary( std::move( payload ), RecordType::KeyValue );
+        }
+    }
 
-    void setEnabled(bool val){
-        mEnabled = val;
+    //   registers 'site' at its first call
+    template<typename... Args>
+    void logKeyValues( KeyValueCallSite& site, const char* file, int line, const Args&... args ){
+        if( isEnabled() ){
+            logKeyValues( site.Get( file, line, args... ), args... );
+        }
     }
 
     //void setFile(const char *filename);
@@ -207,29 +290,39 @@ public:
     //DEFINE_LOGSTREAM_OUT_OPERATOR( const char16_t* )      // need testing
     //DEFINE_LOGSTREAM_OUT_OPERATOR( const char32_t* )      // need testing
     //DEFINE_LOGSTREAM_OUT_OPERATOR( const wchar_t* )       // need testing
-    DEFINE_LOGSTREAM_OUT_OPERATOR( const std::streambuf* )
     DEFINE_LOGSTREAM_OUT_OPERATOR( const std::string& )
 
+    // reads 'data' until its end, straight into the record (eg.: 'pt::log::out << ifs.rdbuf()')
+    //   the buffer of an 'std::ostringstream' is copied whole
+    logstream& operator<<( std::streambuf* data );
     logstream& operator<<( const Name& data);
+    logstream& operator<<( const SendToken& token );
 
     DEFINE_LOGSTREAM_OUT_FUNC_OPERATOR(std::ostream&, (std::ostream&))
     DEFINE_LOGSTREAM_OUT_FUNC_OPERATOR(std::ios&, (std::ios&))
     DEFINE_LOGSTREAM_OUT_FUNC_OPERATOR(std::ios_base&, (std::ios_base&))
 
+    //  containers (see 'setMaxElements()')
+    template<class T, class Allocator>
+    logstream& operator<<( const std::vector<T, Allocator>& list ){
+        if( isEnabled() ){
+            LogElements( list.begin(), list.size() );
+        }
+        return *this;
+    }
+
+    template<class T, size_t N>
+    logstream& operator<<( const std::array<T, N>& list ){
+        if( isEnabled() ){
+            LogElements( list.begin(), N );
+        }
+        return *this;
+    }
+
     template<class T>
-    logstream& operator<<( const std::vector<T> list ){
-        if( mEnabled ){
-            std::ostringstream oss;
-            oss << "[";
-            size_t maxsize = list.size();
-            for( size_t i=0; i<maxsize; ++i ){
-                oss << list[i];
-                if( i+1 < maxsize ){
-                    oss << ", ";
-                }
-            }
-            oss << "]";
-            LogMessage<std::string>( oss.str() ); //TODO: change to 'oss.rdbuf()' after it's compatible
+    logstream& operator<<( const Span<T>& span ){
+        if( isEnabled() ){
+            LogElements( span.data, span.count );
         }
         return *this;
     }
@@ -0,0 +1,94 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    mappedfilesink.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Log file output through a memory-mapped window, without 'write()' syscalls.
+  *            The file is pre-extended in large chunks ('fallocate()'), records are copied straight into the mapping.
+  *            The window is moved forward (remapped), when a write crosses its end.
+  *          Copied data is in the page cache immediately, so it survives a crash of the process
+  *            without flushing (not a crash of the system).
+  *          The preallocated tail reads as zero bytes, until 'Close()' trims the file to its written length.
+  *            Zero bytes left at the end of the file by a killed process are overwritten by the next 'Open()'.
+  *          Rotation is not supported.
+  *          Not thread-safe, written by a single thread (the writer thread of the backend).
+  *            Only the emergency functions may run concurrently with it (crash handler).
+  *          Linux-only, 'Open()' fails on other platforms.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/log/sink.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace pt{
+namespace log{
+
+// implementation of the local log file (see 'pt::log::SetFileMode()')
+enum class FileMode: uint8_t{
+    Buffered = 0,   // 'FileSink': userspace buffer and 'write()'
+    Mapped   = 1,   // 'MappedFileSink'
+};
+
+
+class MappedFileSink: public Sink
+{
+public:
+    static const uint64_t DefaultChunkSize = 64 * 1024 * 1024;
+
+    MappedFileSink();
+    virtual ~MappedFileSink();
+    MappedFileSink( const MappedFileSink& other )               = delete;
+    MappedFileSink( MappedFileSink&& source )                   = delete;
+    MappedFileSink& operator=( const MappedFileSink& other )    = delete;
+    MappedFileSink& operator=( MappedFileSink&& source )        = delete;
+
+    // opens 'path' for appending, creates it if missing
+    //   the file is extended by 'chunk_size' bytes at a time, which is also the size of the mapped window
+    bool Open( const std::string& path, uint64_t chunk_size = DefaultChunkSize );
+    // trims the file to its written length
+    void Close();
+    bool IsOpen() const;
+
+    void Write( const char* data, size_t length );
+    void Write( const std::string& str );
+    void Write( const LogRecord& record ) override;
+    // nothing to do, the data is in the page cache as soon as it is written
+    void Flush() override;
+
+    uint64_t GetWrittenLength() const;
+    const std::string& GetPath() const;
+
+    // async-signal-safe, for the crash handler (see 'crashhandler.h')
+    //   appends with 'pwrite()' instead of the mapping
+    void EmergencyWrite( const char* data, size_t length );
+    //   trims the file and returns its descriptor positioned at the end (-1 if closed)
+    int  EmergencyTrim();
+
+private:
+    struct Window{
+        char*       data  = nullptr;
+        uint64_t    start = 0;      // file offset of 'data'
+        uint64_t    end   = 0;
+    };
+
+    void WriteAt_( uint64_t pos, const char* data, size_t length );
+    // returns false, if 'pos' is behind the current window
+    bool MoveWindow_( uint64_t pos );
+    bool Reserve_( uint64_t end );
+
+    int                     mFileDescriptor = -1;
+    std::string             mPath;
+    uint64_t                mChunkSize = DefaultChunkSize;
+    uint64_t                mAllocated = 0;         // preallocated length of the file
+
+    std::atomic<uint64_t>   mWritePos;              // end of the written data (read by the crash handler)
+    Window                  mWindow;
+    std::string             mHeader;                // reused line header buffer
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,74 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    messagebuffer.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Assembly buffer of a single log record.
+  *            Fragments streamed into a logstream are formatted into this buffer,
+  *            the assembled text is committed as one record when the line is finished.
+  *          Every thread has its own instance for every logstream, so it needs no synchronization.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace pt{
+namespace log{
+
+class logstream;
+
+class MessageBuffer: public std::streambuf
+{
+public:
+    explicit MessageBuffer( const logstream* owner );
+    virtual ~MessageBuffer();
+    MessageBuffer( const MessageBuffer& other )             = delete;
+    MessageBuffer( MessageBuffer&& source )                 = delete;
+    MessageBuffer& operator=( const MessageBuffer& other )  = delete;
+    MessageBuffer& operator=( MessageBuffer&& source )      = delete;
+
+    // format flags (eg.: std::hex) set on the stream persist between records, like with std::cout
+    std::ostream& Stream(){
+        return mStream;
+    }
+
+    const std::string& Text() const{
+        return mText;
+    }
+
+    const logstream* Owner() const{
+        return mOwner;
+    }
+
+    bool IsEmpty() const{
+        return 0 == mText.length();
+    }
+
+    bool EndsLine() const{
+        return ( 0 < mText.length() ) && ( '\n' == mText.back() );
+    }
+
+    // reads 'source' until its end, straight into the record text
+    //   write-only string buffers (of 'std::ostringstream') are copied whole
+    void Append( std::streambuf* source );
+
+    // keeps the allocated capacity for the next record
+    void Clear(){
+        mText.clear();
+    }
+
+protected:
+    int_type        overflow( int_type ch ) override;
+    std::streamsize xsputn( const char* s, std::streamsize n ) override;
+
+private:
+    const logstream*    mOwner;
+    std::string         mText;
+    std::ostream        mStream;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,45 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    ratelimiter.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Lock-free, per-call-site rate limiter for the 'PT_LOG_RATE_LIMITED_*' macros.
+  *            Lets at most 'per_second' messages through in every 1 second window
+  *            and counts the rest, so the next allowed message can report them.
+  *          The window boundaries are approximate under contention:
+  *            a few extra messages may pass right after a window change.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pt{
+namespace log{
+
+class RateLimiter
+{
+public:
+    explicit RateLimiter( uint32_t per_second );
+    virtual ~RateLimiter();
+    RateLimiter( const RateLimiter& other )             = delete;
+    RateLimiter( RateLimiter&& source )                 = delete;
+    RateLimiter& operator=( const RateLimiter& other )  = delete;
+    RateLimiter& operator=( RateLimiter&& source )      = delete;
+
+    // returns true, if the message may be logged
+    //   'suppressed' receives the number of messages dropped since the last allowed one
+    bool TryAcquire( uint64_t& suppressed );
+
+private:
+    static int64_t GetTimeMs_();
+
+    const uint32_t          mPerSecond;
+    std::atomic<int64_t>    mWindowStartMs;
+    std::atomic<uint32_t>   mCount;
+    std::atomic<uint64_t>   mSuppressed;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,138 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    ringbuffer.hpp
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Bounded, lock-free multi-producer/multi-consumer ring buffer.
+  *            Each slot carries a sequence number, that tells producers and consumers
+  *            whether the slot is free to write or ready to read in the current lap.
+  *            Neither side takes a lock, contention is a single CAS on the position counters.
+  *          see: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace pt{
+namespace log{
+
+template<typename T>
+class RingBuffer
+{
+public:
+    // 'capacity' is rounded up to the next power of 2 (minimum 2)
+    explicit RingBuffer( size_t capacity ):
+        mCapacity( RoundUpToPowerOf2( capacity ) ),
+        mMask( mCapacity - 1 ),
+        mSlots( new Slot[ mCapacity ] )
+    {
+        for( size_t i=0; i<mCapacity; ++i ){
+            mSlots[i].sequence.store( i, std::memory_order_relaxed );
+        }
+        mEnqueuePos.store( 0, std::memory_order_relaxed );
+        mDequeuePos.store( 0, std::memory_order_relaxed );
+    }
+
+    virtual ~RingBuffer(){}
+
+    RingBuffer( const RingBuffer& other )               = delete;
+    RingBuffer( RingBuffer&& source )                   = delete;
+    RingBuffer& operator=( const RingBuffer& other )    = delete;
+    RingBuffer& operator=( RingBuffer&& source )        = delete;
+
+    // returns false, if the buffer is full ('item' is left untouched then)
+    bool TryPush( T&& item ){
+        Slot*  slot;
+        size_t pos = mEnqueuePos.load( std::memory_order_relaxed );
+        for(;;){
+            slot = &mSlots[ pos & mMask ];
+            size_t seq = slot->sequence.load( std::memory_order_acquire );
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if( 0 == diff ){
+                if( mEnqueuePos.compare_exchange_weak( pos, pos+1, std::memory_order_relaxed ) ){
+                    break;
+                }
+            }else if( diff < 0 ){
+                return false;
+            }else{
+                pos = mEnqueuePos.load( std::memory_order_relaxed );
+            }
+        }
+        slot->data = std::move( item );
+        slot->sequence.store( pos+1, std::memory_order_release );
+        return true;
+    }
+
+    // returns false, if the buffer is empty
+    bool TryPop( T& item ){
+        Slot*  slot;
+        size_t pos = mDequeuePos.load( std::memory_order_relaxed );
+        for(;;){
+            slot = &mSlots[ pos & mMask ];
+            size_t seq = slot->sequence.load( std::memory_order_acquire );
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos+1);
+            if( 0 == diff ){
+                if( mDequeuePos.compare_exchange_weak( pos, pos+1, std::memory_order_relaxed ) ){
+                    break;
+                }
+            }else if( diff < 0 ){
+                return false;
+            }else{
+                pos = mDequeuePos.load( std::memory_order_relaxed );
+            }
+        }
+        item = std::move( slot->data );
+        slot->sequence.store( pos + mMask + 1, std::memory_order_release );
+        return true;
+    }
+
+    size_t Capacity() const{
+        return mCapacity;
+    }
+
+    // only a snapshot, may already be outdated when returned
+    size_t SizeApprox() const{
+        size_t enq = mEnqueuePos.load( std::memory_order_relaxed );
+        size_t deq = mDequeuePos.load( std::memory_order_relaxed );
+        return (deq < enq) ? (enq - deq) : 0;
+    }
+
+    bool IsEmptyApprox() const{
+        return 0 == SizeApprox();
+    }
+
+private:
+    struct Slot{
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+    static size_t RoundUpToPowerOf2( size_t val ){
+        size_t retval = 2;
+        while( retval < val ){
+            retval <<= 1;
+        }
+        return retval;
+    }
+
+    const size_t                mCapacity;
+    const size_t                mMask;
+    std::unique_ptr<Slot[]>     mSlots;
+
+    // producers and the consumer touch different counters, keep them on separate cache lines
+    //   (padding instead of 'alignas', C++14 'new' does not respect extended alignment)
+    static const size_t CacheLineSize = 64;
+    char                mPadding0[ CacheLineSize ];
+    std::atomic<size_t> mEnqueuePos;
+    char                mPadding1[ CacheLineSize - sizeof(std::atomic<size_t>) ];
+    std::atomic<size_t> mDequeuePos;
+    char                mPadding2[ CacheLineSize - sizeof(std::atomic<size_t>) ];
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,87 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    rotation.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Log file rotation settings and the background worker of rotated files.
+  *          A 'FileSink' with rotation enabled renames its file to '<path>.<N>' at a line boundary
+  *            (N increases with every rotation, starting after the highest N on the disk),
+  *            then reopens '<path>' and goes on writing.
+  *          The rotated files are handed over to a background thread, that
+  *            - compresses them into '<path>.<N>.lz' (see 'compress.h'), if requested
+  *            - deletes the oldest ones above the retention count
+  *              (counting every '<path>.<N>[.lz]' file on the disk, including the ones of earlier runs)
+  *            so the writing thread only pays for a rename.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pt{
+namespace log{
+
+struct RotationSettings{
+    uint64_t    maxFileSize     = 0;        // in bytes (0: no size-based rotation)
+    uint32_t    intervalSeconds = 0;        // rotates at multiples of this wall-clock interval (0: no time-based rotation)
+    uint32_t    maxRotatedFiles = 0;        // retention count of rotated files (0: keep every file)
+    bool        compress        = false;    // compress rotated files with the built-in compressor
+
+    bool IsEnabled() const{
+        return ( 0 < maxFileSize ) || ( 0 < intervalSeconds );
+    }
+};
+
+
+class RotationWorker
+{
+public:
+    RotationWorker();
+    virtual ~RotationWorker();
+    RotationWorker( const RotationWorker& other )               = delete;
+    RotationWorker( RotationWorker&& source )                   = delete;
+    RotationWorker& operator=( const RotationWorker& other )    = delete;
+    RotationWorker& operator=( RotationWorker&& source )        = delete;
+
+    // thread-safe, never blocks on file operations
+    //   'rotated_path' is the renamed file, 'base_path' is the path of the log file it came from
+    void Enqueue( const std::string& base_path, const std::string& rotated_path,
+                  const RotationSettings& settings );
+
+    // blocks until every queued file is processed
+    void WaitIdle();
+
+private:
+    struct Job{
+        std::string         basePath;
+        std::string         rotatedPath;
+        RotationSettings    settings;
+    };
+
+    void WorkerLoop_();
+    void Process_( const Job& job );
+
+    std::mutex              mMutex;
+    std::condition_variable mJobCondition;
+    std::condition_variable mIdleCondition;
+    std::deque<Job>         mJobs;
+    bool                    mBusy = false;
+    bool                    mStopRequested = false;
+    std::thread             mThread;
+};
+
+
+RotationWorker& GetRotationWorker();
+
+// the rotated files of 'base_path' on the disk ('<path>.<N>' and '<path>.<N>.lz'), grouped by N
+std::map< uint64_t, std::vector<std::string> > FindRotatedFiles( const std::string& base_path );
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
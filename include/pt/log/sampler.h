@@ -0,0 +1,68 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    sampler.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Lock-free, per-call-site samplers for the 'PT_LOG_SAMPLED_*' macros.
+  *            'CountSampler' lets every n-th call through (the 1st, the n+1-th, ...).
+  *            'RandomSampler' lets each call through with 1/n probability,
+  *              decided by a thread-local xorshift generator (no shared state on the decision).
+  *          Both count the skipped calls, so the next sampled message can report them.
+  *            The counts are exact in total, but under contention a skipped call
+  *            may be reported by the sample after the one it preceded.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pt{
+namespace log{
+
+class CountSampler
+{
+public:
+    // 'n' of 0 or 1 lets every call through
+    explicit CountSampler( uint32_t n );
+    virtual ~CountSampler();
+    CountSampler( const CountSampler& other )               = delete;
+    CountSampler( CountSampler&& source )                   = delete;
+    CountSampler& operator=( const CountSampler& other )    = delete;
+    CountSampler& operator=( CountSampler&& source )        = delete;
+
+    // returns true, if the call is sampled
+    //   'skipped' receives the number of calls skipped since the last sampled one
+    bool TryAcquire( uint64_t& skipped );
+
+private:
+    const uint64_t          mRate;
+    std::atomic<uint64_t>   mCalls;
+    std::atomic<uint64_t>   mSkipped;
+};
+
+
+class RandomSampler
+{
+public:
+    // 'n' of 0 or 1 lets every call through
+    explicit RandomSampler( uint32_t n );
+    virtual ~RandomSampler();
+    RandomSampler( const RandomSampler& other )             = delete;
+    RandomSampler( RandomSampler&& source )                 = delete;
+    RandomSampler& operator=( const RandomSampler& other )  = delete;
+    RandomSampler& operator=( RandomSampler&& source )      = delete;
+
+    // returns true, if the call is sampled
+    //   'skipped' receives the number of calls skipped since the last sampled one
+    bool TryAcquire( uint64_t& skipped );
+
+private:
+    static uint64_t NextRandom_();
+
+    const uint64_t          mThreshold;     // random values below this are sampled
+    std::atomic<uint64_t>   mSkipped;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
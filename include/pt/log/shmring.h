@@ -0,0 +1,91 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    shmring.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Inter-process log record ring in POSIX shared memory.
+  *            The logger daemon ('ptlib_logd') creates the segment and is its only consumer.
+  *            Any number of client processes (and threads) attach to it and append records.
+  *          Producers only wait for each other during the reservation of space (a few stores under
+  *            a process-shared, robust mutex), they copy their data and commit it in parallel.
+  *            'TryWrite()' returns false immediately, if the ring is full.
+  *          A record, that its producer doesn't commit (eg.: it died) is skipped after a timeout.
+  *          The consumer sleeps on a futex in the segment, producers wake it with 'Notify()'.
+  *          The daemon refreshes a heartbeat in the segment, so clients can detect, if it is gone.
+  *          Linux-only, the functions fail on other platforms.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace pt{
+namespace log{
+
+class SharedMemoryRing
+{
+public:
+    using RecordCallback = std::function< void( const char* data, size_t length ) >;
+
+    static const uint64_t DefaultCapacity = 8 * 1024 * 1024;
+
+    SharedMemoryRing();
+    virtual ~SharedMemoryRing();
+    SharedMemoryRing( const SharedMemoryRing& other )               = delete;
+    SharedMemoryRing( SharedMemoryRing&& source )                   = delete;
+    SharedMemoryRing& operator=( const SharedMemoryRing& other )    = delete;
+    SharedMemoryRing& operator=( SharedMemoryRing&& source )        = delete;
+
+    // daemon side
+    //   creates (or replaces a stale) segment called 'name' (eg.: "/ptlib_log")
+    //   'capacity' is rounded up to the next power of 2
+    bool Create( const std::string& name, uint64_t capacity = DefaultCapacity );
+
+    // client side
+    //   keeps retrying for 'timeout_ms' milliseconds, until a live daemon's segment is found
+    bool Attach( const std::string& name, uint32_t timeout_ms );
+
+    // unmaps the segment, the creator also unlinks it
+    void Close();
+    bool IsOpen() const;
+
+    //-----
+    // producer side (thread- and process-safe)
+
+    // returns false, if the ring is full or 'length' exceeds a quarter of the capacity
+    bool TryWrite( const char* data, size_t length );
+    // wakes the consumer, if it is sleeping
+    //   call it once after a group of 'TryWrite()' calls
+    void Notify();
+    bool IsConsumerAlive( uint32_t timeout_ms ) const;
+
+    //-----
+    // consumer side (single consumer)
+
+    // calls 'callback' for at most 'max_records' committed records, returns their count
+    size_t Consume( const RecordCallback& callback, size_t max_records );
+    // sleeps until new records arrive or 'timeout_ms' passes
+    void Wait( uint32_t timeout_ms );
+    void UpdateHeartbeat();
+
+private:
+    bool LockReservation_();
+    bool Map_( int fd, uint64_t size );
+
+    std::string mName;
+    void*       mMapping     = nullptr;
+    uint64_t    mMappingSize = 0;
+    uint64_t    mCapacity    = 0;
+    uint64_t    mMask        = 0;
+    char*       mData        = nullptr;
+    bool        mOwner       = false;
+
+    // consumer-side bookkeeping of a reserved, but never committed record
+    uint64_t    mStalledPos       = UINT64_MAX;
+    int64_t     mStalledSinceMs   = 0;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
@@ -0,0 +1,108 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    sink.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Log outputs (sinks), that the logstreams can be bound to (see 'pt::log::BindSinks()').
+  *          Sinks receive already formatted text records.
+  *            They are written only by the writer thread of the backend
+  *            (or by the logging thread under a lock, while the writer thread is not running),
+  *            so implementations don't need to be thread-safe.
+  *          File-like sinks start each record with 'AppendLineHeader()', the console only gets the text.
+  *          'Flush()' is called after writes, that completed a line (if flush-on-send is set),
+  *            periodically (see 'pt::log::SetFlushInterval()') and on shutdown.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include "pt/log/logrecord.h"
+
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pt{
+namespace log{
+
+class Sink
+{
+public:
+    Sink();
+    virtual ~Sink();
+    Sink( const Sink& other )               = delete;
+    Sink( Sink&& source )                   = delete;
+    Sink& operator=( const Sink& other )    = delete;
+    Sink& operator=( Sink&& source )        = delete;
+
+    virtual void Write( const LogRecord& record ) = 0;
+    virtual void Flush();
+};
+
+using SinkList = std::vector< std::shared_ptr<Sink> >;
+
+
+// appends the line header of the stored (non-console) outputs: "<timestamp> <prefix>: "
+//   nothing for JSON records
+//   timestamps are formatted with a cached formatter of the calling thread (see 'timestamp.h')
+void AppendLineHeader( const LogRecord& record, std::string& out );
+// enabled by default
+void SetLineTimestamps( bool enabled );
+
+
+// writes the text of the records to std::cout (without the stream prefix)
+class ConsoleSink: public Sink
+{
+public:
+    ConsoleSink();
+    virtual ~ConsoleSink();
+
+    void Write( const LogRecord& record ) override;
+    void Flush() override;
+};
+
+
+// discards every record
+class NullSink: public Sink
+{
+public:
+    NullSink();
+    virtual ~NullSink();
+
+    void Write( const LogRecord& record ) override;
+};
+
+
+// keeps the most recent records in a fixed-size ring in memory
+//   the contents can be read at any time (eg.: dumped on a crash)
+//   the oldest records are overwritten, when the ring is full
+class MemorySink: public Sink
+{
+public:
+    static const size_t DefaultCapacity = 1024 * 1024;
+
+    explicit MemorySink( size_t capacity = DefaultCapacity );
+    virtual ~MemorySink();
+
+    void Write( const LogRecord& record ) override;
+
+    // thread-safe
+    //   returns the stored records oldest first, without the partially overwritten first line
+    std::string GetContents() const;
+    void        Dump( std::ostream& os ) const;
+    void        Clear();
+    size_t      GetCapacity() const;
+
+private:
+    void Append_( const char* data, size_t length );
+
+    mutable std::mutex  mMutex;
+    std::vector<char>   mBuffer;
+    size_t              mWritePos = 0;
+    bool                mWrapped  = false;
+    std::string         mHeaderScratch;
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
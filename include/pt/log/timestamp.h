@@ -0,0 +1,44 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    timestamp.h
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Cheap timestamps for log records.
+  *          'GetTimestamp()' reads a coarse clock where available (CLOCK_REALTIME_COARSE on Linux),
+  *            that costs a few nanoseconds, but only has a resolution of a few milliseconds.
+  *          'TimestampFormatter' caches the formatted date and time of the current second
+  *            ('localtime' and the formatting only run once per second),
+  *            every record only fills in the millisecond digits.
+  * -----------------------------------------------------------------------------
+  */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pt{
+namespace log{
+
+// nanoseconds since epoch (wall-clock)
+int64_t GetTimestamp();
+
+
+// formats timestamps as "YYYY-MM-DD HH:MM:SS.mmm" in local time
+//   not thread-safe, use one instance per thread
+class TimestampFormatter
+{
+public:
+    static const size_t Length = 23;
+
+    // writes exactly 'Length' characters into 'out' (no terminating zero)
+    void Format( int64_t timestamp, char* out );
+
+private:
+    void UpdateCache_( int64_t second );
+
+    int64_t mCachedSecond = INT64_MIN;
+    char    mCache[Length];
+};
+
+} //end of namespace 'log'
+} //end of namespace 'pt'
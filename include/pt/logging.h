@@ -9,8 +9,16 @@
 
 #pragma once
 
+#include "pt/log/category.h"
+#include "pt/log/kvrecord.h"
 #include "pt/log/logstream.hpp"
+#include "pt/log/mappedfilesink.h"
+#include "pt/log/ratelimiter.h"
+#include "pt/log/rotation.h"
+#include "pt/log/sampler.h"
+#include "pt/log/sink.h"
 
+#include <atomic>
 #include <string>
 #include <cstring>
 
@@ -19,9 +27,10 @@
 namespace pt{
 namespace log{
 
-//TODO: refactor (placeholder)
-//  enables early references to 'pt::log::send'
-const char send = '\n';
+// terminates the record (line) being assembled and hands it over for writing
+//  until receiving this, 'operator<<' calls only fill the calling thread's message buffer
+//  (fragments, that end with a newline character also terminate the record)
+const SendToken send = SendToken();
 
 const uint32_t default_timeout = 5000;
 
@@ -33,16 +42,109 @@ const std::string& GetFileName();
 
 //'rootdir' has to exist already
 //directories in 'filepath' are created if missing
-//'default_timeout' is the time to wait for the logging subprocess to start responding (not yet relevant)
+//'timeout' is the time to wait for the logger daemon to start responding (see 'SetDaemonName()')
 bool Initialize(const std::string& rootdir,
                 const std::string& filepath,
                 uint32_t timeout = default_timeout);
 
 
 void Destroy();
+// applies the settings file (see 'SetSettingsFile()'), called by 'Initialize()'
 void LoadSettings();
 
 
+// Runtime settings
+//   the settings file has 'key = value' lines, '#' starts a comment, values are on/off/true/false/1/0
+//     stream.<debug|out|warn|err>   enables/disables a stream
+//     category.<name>               enables/disables a category (see 'pt/log/category.h' and 'PT_LOG_CAT_*')
+//     category.*                    enables/disables every category
+//   lines are applied in order, settings missing from the file keep their current value
+//   eg.: category.* = off
+//        category.net = on
+void SetSettingsFile( const std::string& path );
+// the settings file is reloaded by the writer thread, when the process receives 'signal' (eg.: SIGUSR1)
+//   returns false if the handler couldn't be installed (Linux-only)
+bool SetSettingsReloadSignal( int signal );
+
+
+// File output settings
+//   have to be set before calling 'Initialize()'
+
+// capacity of the queue between the logging threads and the writer thread, in records
+void SetQueueCapacity( size_t records );
+// size of the userspace file buffer in bytes, it is written out when full (0: unbuffered)
+void SetFileBufferSize( size_t bytes );
+// the file buffer is flushed at least this often (0: disabled)
+void SetFlushInterval( uint32_t milliseconds );
+// flush the file buffer after writing records that received 'pt::log::send'
+//   multiple records arriving together are flushed together
+void SetFlushOnSend( bool enabled );
+// rotation of the log file by size and/or time, with retention and compression (see 'pt/log/rotation.h')
+//   rotated files are compressed and deleted on a background thread
+//   eg.: 100MB files, at least daily, keeping the last 10 compressed:
+//        pt::log::SetRotation( { 100*1024*1024, 24*3600, 10, true } );
+void SetRotation( const RotationSettings& settings );
+// 'FileMode::Mapped' writes the log file through a memory mapping, that is extended in 64MB chunks,
+//   instead of a userspace buffer and 'write()' calls (see 'pt/log/mappedfilesink.h')
+//   the file is trimmed to its real length in 'Destroy()', rotation settings are ignored in this mode
+//   default: 'FileMode::Buffered'
+void SetFileMode( FileMode mode );
+// start the lines of the log file (and the other stored outputs) with the local time of the record
+//   eg.: "2026-10-18 07:05:27.123 Log: message"
+//   records are timestamped with a coarse clock (a few milliseconds resolution)
+//   enabled by default, can be changed at any time
+void SetTimestamps( bool enabled );
+// output format of 'PT_LOG_KV' records: JSON lines (default) or logfmt, can be changed at any time
+void SetKeyValueFormat( KeyValueFormat format );
+// on SIGSEGV, SIGABRT and SIGBUS, write the buffered and queued records and a stack trace
+//   into the log file, before the process terminates (see 'pt/log/crashhandler.h')
+//   the handler is installed in 'Initialize()' and removed in 'Destroy()', enabled by default (Linux-only)
+void SetCrashHandler( bool enabled );
+
+
+// Overload behaviour
+//   each stream has its own 'OverflowPolicy' for the case, when the queue of the writer thread is full
+//     (see 'pt/log/logstream.hpp' and 'logstream::setOverflowPolicy()')
+//   defaults: 'debug' and 'out' drop the new record, 'warn' and 'err' block (never drop)
+//   has to be set before calling 'Initialize()'
+
+// severity threshold of 'OverflowPolicy::DropBelowSeverity' (PT_LOG_LEVEL_*, default: PT_LOG_LEVEL_WARN)
+void SetOverflowSeverity( uint8_t level );
+// dropped records are counted per stream and reported into 'warn' this often (0: only in 'Destroy()')
+void SetDropReportInterval( uint32_t milliseconds );
+
+
+// Multiprocess logging
+//   if set, log file records are sent through the shared memory segment 'shm_name' (eg.: "/ptlib_log")
+//     to a logger daemon ('ptlib_logd'), that writes them to its own log file
+//   if the daemon doesn't respond within the 'timeout' of 'Initialize()' (or stops responding later),
+//     records are written into the local log file instead
+//   "" disables multiprocess logging (default)
+//   has to be set before calling 'Initialize()'
+void SetDaemonName( const std::string& shm_name );
+bool IsConnectedToDaemon();
+
+
+// Sinks (outputs)
+//   records of a stream are written into every sink bound to it
+//   streams without an explicit binding write into "console" (std::cout) and "file" (see 'Initialize()')
+//   built-in sinks: "console", "file", "null"
+//   bindings can be changed at any time, from any thread
+//   eg.: pt::log::RegisterSink( "memory", std::make_shared<pt::log::MemorySink>() );
+//        pt::log::BindSinks( pt::log::debug, {"memory"} );
+//        pt::log::BindSinks( pt::log::out, {"file"} );       // no std::cout output
+
+// returns false, if 'name' is already taken or 'sink' is null
+bool RegisterSink( const std::string& name, std::shared_ptr<Sink> sink );
+// returns null, if 'name' is not registered
+std::shared_ptr<Sink> GetSink( const std::string& name );
+// returns false and keeps the current binding, if any of the names is not registered
+bool BindSinks( const logstream& stream, const std::vector<std::string>& sink_names );
+void BindSinks( const logstream& stream, const SinkList& sinks );
+// restores the default sinks of 'stream'
+void ResetSinks( const logstream& stream );
+
+
 extern logstream debug;
 extern logstream out;
 extern logstream warn;
@@ -51,57 +153,206 @@ extern logstream err;
 } //end of namespace 'log'
 
 
-// Macro versions of loggers
-#define PT_LOG_INFO(expr) pt::log::out << expr << pt::log::send
-#define PT_LOG_OUT(expr)  pt::log::out << expr << pt::log::send   //deprecated, will be removed in a later version
-#define PT_LOG_WARN(expr) pt::log::warn << "WARNING: " << expr << pt::log::send
-#define PT_LOG_ERR(expr)  pt::log::err << "ERROR: " << expr << pt::log::send
+// Log levels for compile-time elimination
+//   macros below 'PT_LOG_MIN_LEVEL' expand to nothing (their arguments are not even compiled)
+//   eg.: -DPT_LOG_MIN_LEVEL=PT_LOG_LEVEL_WARN removes every DEBUG and INFO logging call
+//   PT_LOG_*_DEBUG macros additionally need 'PT_DEBUG_ENABLED'
+//   (the levels are defined in 'pt/log/logstream.hpp')
+#ifndef PT_LOG_MIN_LEVEL
+#define PT_LOG_MIN_LEVEL PT_LOG_LEVEL_DEBUG
+#endif
 
-#define __PT_LOG_ONCE( __LOGSTREAM, expr ) \
+// Streams disabled at runtime (see 'logstream::setEnabled()') skip evaluating 'expr' entirely,
+//   a disabled logging call costs a single branch
+#define __PT_LOG_EXPR( __LOGSTREAM, __PREFIX, expr ) \
+    ( !__LOGSTREAM.isEnabled() ) ? __PT_VOID_CAST (0) \
+                                 : __PT_VOID_CAST ( __LOGSTREAM << __PREFIX << expr << pt::log::send )
+
+// The counters are atomic: every thread shares the limits of the call site,
+//   once the limit is reached, a call only costs a relaxed load
+#define __PT_LOG_ONCE( __LOGSTREAM, __PREFIX, expr ) \
 { \
-    static bool firsttime = true; \
-    if( firsttime ){ \
-        __LOGSTREAM << expr << pt::log::send; \
-        firsttime = false; \
+    static std::atomic<bool> __pt_log_done( false ); \
+    if( __LOGSTREAM.isEnabled() \
+        && !__pt_log_done.load( std::memory_order_relaxed ) \
+        && !__pt_log_done.exchange( true, std::memory_order_relaxed ) ){ \
+        __LOGSTREAM << __PREFIX << expr << pt::log::send; \
     } \
 }
 
-#define PT_LOG_ONCE_INFO(expr) __PT_LOG_ONCE( pt::log::out, expr )
-#define PT_LOG_ONCE_WARN(expr) __PT_LOG_ONCE( pt::log::warn << "WARNING: " , expr )
-#define PT_LOG_ONCE_ERR(expr) __PT_LOG_ONCE( pt::log::err << "ERROR: " , expr )
+#define __PT_LOG_LIMITED( __LOGSTREAM, __PREFIX, log_limit, expr ) \
+{ \
+    static std::atomic<size_t> __pt_log_count( 0 ); \
+    const size_t __pt_log_limit = log_limit; \
+    if( __LOGSTREAM.isEnabled() \
+        && ( __pt_log_count.load( std::memory_order_relaxed ) < __pt_log_limit ) ){ \
+        const size_t __pt_log_index = __pt_log_count.fetch_add( 1, std::memory_order_relaxed ) + 1; \
+        if( __pt_log_index <= __pt_log_limit ){ \
+            __LOGSTREAM << __PREFIX << expr << pt::log::send; \
+        } \
+        if( __pt_log_index == __pt_log_limit ){ \
+            __LOGSTREAM << __PREFIX << "  Limit(" << __pt_log_limit << ") reached. Suppressing further logging of this message." << pt::log::send; \
+        } \
+    } \
+}
 
+// logs at most 'per_second' messages per second from the call site
+//   the first message after a suppressed period reports the number of dropped messages
+#define __PT_LOG_RATE_LIMITED( __LOGSTREAM, __PREFIX, per_second, expr ) \
+{ \
+    static pt::log::RateLimiter __pt_log_limiter( per_second ); \
+    uint64_t __pt_log_suppressed = 0; \
+    if( __LOGSTREAM.isEnabled() && __pt_log_limiter.TryAcquire( __pt_log_suppressed ) ){ \
+        if( 0 < __pt_log_suppressed ){ \
+            __LOGSTREAM << __PREFIX << "  Rate limit(" << (per_second) << "/s) suppressed " << __pt_log_suppressed << " messages." << pt::log::send; \
+        } \
+        __LOGSTREAM << __PREFIX << expr << pt::log::send; \
+    } \
+}
 
-#define __PT_LOG_LIMITED( __LOGSTREAM, log_limit, expr ) \
+// logs a sample of the calls ('__SAMPLER' is 'pt::log::CountSampler' or 'pt::log::RandomSampler')
+//   'expr' is only evaluated for the sampled calls, which report the number of calls skipped before them
+//   eg.: "[sampled 1/100, skipped 99] message"
+#define __PT_LOG_SAMPLED( __LOGSTREAM, __PREFIX, __SAMPLER, sample_rate, expr ) \
 { \
-    static size_t count = 1; \
-    size_t limit = log_limit; \
-    if( count < limit ){ \
-        __LOGSTREAM << expr << pt::log::send; \
-        ++count; \
-    }else if( count == limit ){ \
-        __LOGSTREAM << expr << pt::log::send; \
-        __LOGSTREAM << "  Limit(" << limit << ") reached. Suppressing further logging of this message." << pt::log::send; \
-        ++count; \
+    static __SAMPLER __pt_log_sampler( sample_rate ); \
+    uint64_t __pt_log_skipped = 0; \
+    if( __LOGSTREAM.isEnabled() && __pt_log_sampler.TryAcquire( __pt_log_skipped ) ){ \
+        __LOGSTREAM << __PREFIX << "[sampled 1/" << (sample_rate) << ", skipped " << __pt_log_skipped << "] " << expr << pt::log::send; \
     } \
 }
 
-#define PT_LOG_LIMITED_INFO(log_limit, expr) __PT_LOG_LIMITED( pt::log::out, log_limit, expr )
-#define PT_LOG_LIMITED_WARN(log_limit, expr) __PT_LOG_LIMITED( pt::log::warn << "WARNING: " , log_limit, expr )
-#define PT_LOG_LIMITED_ERR(log_limit, expr) __PT_LOG_LIMITED( pt::log::err << "ERROR: " , log_limit, expr )
+// logs only while 'category' (a 'pt::Name' or string literal) is enabled, eg.: "[net] message"
+//   a disabled category costs a single relaxed atomic load, 'expr' is not evaluated
+#define __PT_LOG_CAT( __LOGSTREAM, __PREFIX, category, expr ) \
+{ \
+    static const pt::log::Category __pt_log_category{ pt::Name( category ) }; \
+    if( __pt_log_category.IsEnabled() && __LOGSTREAM.isEnabled() ){ \
+        __LOGSTREAM << __PREFIX << "[" << __pt_log_category.GetName() << "] " << expr << pt::log::send; \
+    } \
+}
+
+// Deferred-formatting (binary) versions of loggers
+//   'format' has to be a string literal, '{}' marks the places of the arguments
+//   eg.: PT_LOG_BINARY_INFO( "request {} took {}us", request_id, duration );
+//   the calling thread only copies the raw argument values, text formatting happens on the writer thread
+//   see 'pt/log/binrecord.h' for the supported argument types
+#define __PT_LOG_BINARY( __LOGSTREAM, format, ... ) \
+{ \
+    if( __LOGSTREAM.isEnabled() ){ \
+        static const uint32_t __pt_log_site = pt::log::RegisterFormatSite( format, __FILE__, __LINE__ ); \
+        __LOGSTREAM.logBinary( __pt_log_site, ##__VA_ARGS__ ); \
+    } \
+}
+
+// Structured (key-value) logging
+//   '__LOGSTREAM' is one of 'debug', 'out', 'warn' and 'err', the rest are key-value pairs
+//   eg.: PT_LOG_KV( out, "event", pt::Name( "cache_miss" ), "key", key, "lat_us", latency );
+//   keys (string literals or 'pt::Name'-s) are interned once per call site, records only carry the values
+//   every argument is evaluated once, the call site is registered from them at its first call
+//   the writer thread encodes them as JSON lines or logfmt (see 'pt/log/kvrecord.h' and 'SetKeyValueFormat()')
+#define PT_LOG_KV( __LOGSTREAM, ... ) __PT_LOG_KV_##__LOGSTREAM( __VA_ARGS__ )
+
+#define __PT_LOG_KV( __LOGSTREAM, ... ) \
+{ \
+    if( __LOGSTREAM.isEnabled() ){ \
+        static pt::log::KeyValueCallSite __pt_log_site; \
+        __LOGSTREAM.logKeyValues( __pt_log_site, __FILE__, __LINE__, __VA_ARGS__ ); \
+    } \
+}
 
+
+// Macro versions of loggers
 //Like assertions, PT_LOG_DEBUG can be macro-disabled
 //  to eliminate unnecessary performance footprint in release builds
-#ifdef PT_DEBUG_ENABLED
-//TODO: implement 'pt::log::send'
-//  until receiving that value, the operator<< calls only fill up a local buffer
-//  upon receiving that value, logging will initiate inter-process message transmission
-#define PT_LOG_DEBUG(expr) pt::log::debug << expr << pt::log::send
-#define PT_LOG_ONCE_DEBUG(expr) __PT_LOG_ONCE( pt::log::debug, expr )
-#define PT_LOG_LIMITED_DEBUG(log_limit, expr) __PT_LOG_LIMITED( pt::log::debug, log_limit, expr )
+#if defined PT_DEBUG_ENABLED && ( PT_LOG_MIN_LEVEL <= PT_LOG_LEVEL_DEBUG )
+#define PT_LOG_DEBUG(expr) ( __PT_LOG_EXPR( pt::log::debug, "", expr ) )
+#define PT_LOG_ONCE_DEBUG(expr) __PT_LOG_ONCE( pt::log::debug, "", expr )
+#define PT_LOG_LIMITED_DEBUG(log_limit, expr) __PT_LOG_LIMITED( pt::log::debug, "", log_limit, expr )
+#define PT_LOG_RATE_LIMITED_DEBUG(per_second, expr) __PT_LOG_RATE_LIMITED( pt::log::debug, "", per_second, expr )
+#define PT_LOG_SAMPLED_DEBUG(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::debug, "", pt::log::CountSampler, sample_rate, expr )
+#define PT_LOG_SAMPLED_RANDOM_DEBUG(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::debug, "", pt::log::RandomSampler, sample_rate, expr )
+#define PT_LOG_CAT_DEBUG(category, expr) __PT_LOG_CAT( pt::log::debug, "", category, expr )
+#define PT_LOG_BINARY_DEBUG(format, ...) __PT_LOG_BINARY( pt::log::debug, format, ##__VA_ARGS__ )
+#define __PT_LOG_KV_debug(...) __PT_LOG_KV( pt::log::debug, __VA_ARGS__ )
 #else
 #define PT_LOG_DEBUG(expr) (__PT_VOID_CAST (0))
 #define PT_LOG_ONCE_DEBUG(expr) (__PT_VOID_CAST (0))
 #define PT_LOG_LIMITED_DEBUG(log_limit, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_RATE_LIMITED_DEBUG(per_second, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_DEBUG(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_RANDOM_DEBUG(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_CAT_DEBUG(category, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_BINARY_DEBUG(format, ...) (__PT_VOID_CAST (0))
+#define __PT_LOG_KV_debug(...) (__PT_VOID_CAST (0))
+#endif
+
+#if PT_LOG_MIN_LEVEL <= PT_LOG_LEVEL_INFO
+#define PT_LOG_INFO(expr) ( __PT_LOG_EXPR( pt::log::out, "", expr ) )
+#define PT_LOG_OUT(expr)  ( __PT_LOG_EXPR( pt::log::out, "", expr ) )  //deprecated, will be removed in a later version
+#define PT_LOG_ONCE_INFO(expr) __PT_LOG_ONCE( pt::log::out, "", expr )
+#define PT_LOG_LIMITED_INFO(log_limit, expr) __PT_LOG_LIMITED( pt::log::out, "", log_limit, expr )
+#define PT_LOG_RATE_LIMITED_INFO(per_second, expr) __PT_LOG_RATE_LIMITED( pt::log::out, "", per_second, expr )
+#define PT_LOG_SAMPLED_INFO(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::out, "", pt::log::CountSampler, sample_rate, expr )
+#define PT_LOG_SAMPLED_RANDOM_INFO(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::out, "", pt::log::RandomSampler, sample_rate, expr )
+#define PT_LOG_CAT_INFO(category, expr) __PT_LOG_CAT( pt::log::out, "", category, expr )
+#define PT_LOG_BINARY_INFO(format, ...) __PT_LOG_BINARY( pt::log::out, format, ##__VA_ARGS__ )
+#define __PT_LOG_KV_out(...) __PT_LOG_KV( pt::log::out, __VA_ARGS__ )
+#else
+#define PT_LOG_INFO(expr) (__PT_VOID_CAST (0))
+#define PT_LOG_OUT(expr)  (__PT_VOID_CAST (0))
+#define PT_LOG_ONCE_INFO(expr) (__PT_VOID_CAST (0))
+#define PT_LOG_LIMITED_INFO(log_limit, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_RATE_LIMITED_INFO(per_second, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_INFO(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_RANDOM_INFO(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_CAT_INFO(category, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_BINARY_INFO(format, ...) (__PT_VOID_CAST (0))
+#define __PT_LOG_KV_out(...) (__PT_VOID_CAST (0))
+#endif
+
+#if PT_LOG_MIN_LEVEL <= PT_LOG_LEVEL_WARN
+#define PT_LOG_WARN(expr) ( __PT_LOG_EXPR( pt::log::warn, "WARNING: ", expr ) )
+#define PT_LOG_ONCE_WARN(expr) __PT_LOG_ONCE( pt::log::warn, "WARNING: ", expr )
+#define PT_LOG_LIMITED_WARN(log_limit, expr) __PT_LOG_LIMITED( pt::log::warn, "WARNING: ", log_limit, expr )
+#define PT_LOG_RATE_LIMITED_WARN(per_second, expr) __PT_LOG_RATE_LIMITED( pt::log::warn, "WARNING: ", per_second, expr )
+#define PT_LOG_SAMPLED_WARN(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::warn, "WARNING: ", pt::log::CountSampler, sample_rate, expr )
+#define PT_LOG_SAMPLED_RANDOM_WARN(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::warn, "WARNING: ", pt::log::RandomSampler, sample_rate, expr )
+#define PT_LOG_CAT_WARN(category, expr) __PT_LOG_CAT( pt::log::warn, "WARNING: ", category, expr )
+#define PT_LOG_BINARY_WARN(format, ...) __PT_LOG_BINARY( pt::log::warn, "WARNING: " format, ##__VA_ARGS__ )
+#define __PT_LOG_KV_warn(...) __PT_LOG_KV( pt::log::warn, __VA_ARGS__ )
+#else
+#define PT_LOG_WARN(expr) (__PT_VOID_CAST (0))
+#define PT_LOG_ONCE_WARN(expr) (__PT_VOID_CAST (0))
+#define PT_LOG_LIMITED_WARN(log_limit, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_RATE_LIMITED_WARN(per_second, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_WARN(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_RANDOM_WARN(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_CAT_WARN(category, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_BINARY_WARN(format, ...) (__PT_VOID_CAST (0))
+#define __PT_LOG_KV_warn(...) (__PT_VOID_CAST (0))
+#endif
+
+#if PT_LOG_MIN_LEVEL <= PT_LOG_LEVEL_ERR
+#define PT_LOG_ERR(expr) ( __PT_LOG_EXPR( pt::log::err, "ERROR: ", expr ) )
+#define PT_LOG_ONCE_ERR(expr) __PT_LOG_ONCE( pt::log::err, "ERROR: ", expr )
+#define PT_LOG_LIMITED_ERR(log_limit, expr) __PT_LOG_LIMITED( pt::log::err, "ERROR: ", log_limit, expr )
+#define PT_LOG_RATE_LIMITED_ERR(per_second, expr) __PT_LOG_RATE_LIMITED( pt::log::err, "ERROR: ", per_second, expr )
+#define PT_LOG_SAMPLED_ERR(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::err, "ERROR: ", pt::log::CountSampler, sample_rate, expr )
+#define PT_LOG_SAMPLED_RANDOM_ERR(sample_rate, expr) __PT_LOG_SAMPLED( pt::log::err, "ERROR: ", pt::log::RandomSampler, sample_rate, expr )
+#define PT_LOG_CAT_ERR(category, expr) __PT_LOG_CAT( pt::log::err, "ERROR: ", category, expr )
+#define PT_LOG_BINARY_ERR(format, ...) __PT_LOG_BINARY( pt::log::err, "ERROR: " format, ##__VA_ARGS__ )
+#define __PT_LOG_KV_err(...) __PT_LOG_KV( pt::log::err, __VA_ARGS__ )
+#else
+#define PT_LOG_ERR(expr) (__PT_VOID_CAST (0))
+#define PT_LOG_ONCE_ERR(expr) (__PT_VOID_CAST (0))
+#define PT_LOG_LIMITED_ERR(log_limit, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_RATE_LIMITED_ERR(per_second, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_ERR(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_SAMPLED_RANDOM_ERR(sample_rate, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_CAT_ERR(category, expr) (__PT_VOID_CAST (0))
+#define PT_LOG_BINARY_ERR(format, ...) (__PT_VOID_CAST (0))
+#define __PT_LOG_KV_err(...) (__PT_VOID_CAST (0))
 #endif
 
 } //end of namespace 'pt'
@@ -4,14 +4,23 @@
  * AUTHOR:  Peter Toth
  * E-MAIL:  peter.t.toth92@gmail.com
  * PURPOSE:
- *   A reference-counted string class optimized for frequent comparisons.
+ *   An interned string class optimized for frequent comparisons.
  *    Goal is to achieve features similar to UnrealScript's 'name' class.
  *      Each unique string has a globally unique uint64_t id.
  *      Name-Name comparison is just an integer (id) comparison.
- *      Construction from string data is 1 alloc slower. (shared_ptr)
- *      Copies are cheap (id + shared_ptr).
- *      One-time global state-sync is slow (hashing, global race condition, map-search, alloc).
- *      Each unique Name data is kept once, globally, even after instances are destroyed.
+ *        So are 'operator<' (orders by id, see 'NameLexicalLess' for string order)
+ *        and 'std::hash<pt::Name>', names are cheap keys of 'std::map' and 'std::unordered_map'.
+ *      Construction from string data interns the string (hashing, locked table-search).
+ *        The global table is split into shards by hash, each with its own lock,
+ *        so threads interning different strings rarely wait for each other.
+ *      The characters of each unique string are stored once, globally, packed into
+ *        large append-only arenas, and are never freed.
+ *      Instances only refer to the stored string, they are trivially copyable (pointer + id, no ref-counting).
+ *      'FindById()' is a lock-free O(1) table lookup.
+ *      Ids fit into 32 bits, 'pt::NameId' is a 4-byte handle for storing names in large arrays.
+ *      With 'PT_NAME_COMPACT' defined, 'pt::Name' itself only stores the 32-bit id (4 bytes),
+ *        and resolves its string through the id table when needed.
+ *        The macro has to be the same for the library and its users.
  *    Recommended usage:
  *      Avoid one-time use. (prefer 'static const')
  *      Frequent comparisons will pay back initial performance cost.
@@ -20,104 +29,284 @@
  *        static const pt::Name my_name2( "AssetName" );
  *        ...
  *        my_name1 == my_name2; // comparison is O(1): int == int
- *                              // (first-time comparison may involve late-init)
  *        ...
  *      }
- *    In order to avoid static init-order issues,
- *      global index is only acquired during late-init at first usage.
- *    Non-synced instances can be copied.
- *      This can hurt performance as later, each instance will sync separately.
- *      Calling '.Init()' will ensure synced-state, before copying instance.
- *    The following 'const' functions on uninitialized instances will initiate late-init.
- *      - comparison operators (== and !=)
- *          They init the right-side instance too!
- *      - GetStdString()
+ *    String literals can be hashed at compile time, so interning them skips the hashing:
+ *      PT_NAME( "AssetName" )          interned once per call site (like a 'static const' instance), string literals only
+ *      "AssetName"_name                'pt::NameLiteral', converts to 'pt::Name' (needs 'using namespace pt::literals')
+ *                                        every conversion interns (locked table-search), prefer 'PT_NAME()' in hot code
+ *      name == "AssetName"_name        compares hash, length and characters, without interning the literal
+ *    'GetHash()' and the 'constexpr' hash of literals can drive 'switch'-based dispatch,
+ *      cases still have to compare the names, as different strings can have the same hash:
+ *      switch( name.GetHash() ){
+ *      case "Idle"_name.GetHash():  if( name == "Idle"_name ){ ... } break;
+ *      ...
+ *      }
+ *    The global table is created at its first use, so instances can be
+ *      constructed during static initialization too.
+ *    Existing names can be looked up by 'std::string_view' without allocation ('Find()').
+ *    'GetStdString()' creates an 'std::string' copy of each unique string at its first call,
+ *      'c_str()' and 'length()' don't allocate.
  * -------------------------------------------------------------------------
  */
 
 #pragma once
 
-#include <memory>
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <ostream>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 
 namespace pt{
 
+// a unique string stored in the global table (internal, defined in 'name.cpp')
+struct NameEntry;
+class NameLiteral;
+
+const uint32_t NameHashSeed = 0x5f3759df; // note: the seed chosen here had no considerations of any kind
+
+// MurmurHash2 of 'str' (same as 'pt::MurmurHash2()' on little-endian platforms)
+//   usable in constant expressions, eg.: for hashing string literals at compile time
+constexpr uint32_t
+HashName( const char* str, size_t length, uint32_t seed = NameHashSeed )
+{
+    const uint32_t m = 0x5bd1e995;
+    const int      r = 24;
+    uint32_t h = seed ^ static_cast<uint32_t>( length );
+
+    size_t i = 0;
+    for( ; 4 <= length - i; i += 4 ){
+        uint32_t k =  static_cast<uint32_t>( static_cast<unsigned char>( str[i] ) )
+                   | (static_cast<uint32_t>( static_cast<unsigned char>( str[i+1] ) ) << 8)
+                   | (static_cast<uint32_t>( static_cast<unsigned char>( str[i+2] ) ) << 16)
+                   | (static_cast<uint32_t>( static_cast<unsigned char>( str[i+3] ) ) << 24);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h *= m;
+        h ^= k;
+    }
+
+    const size_t tail = length - i;
+    if( 3 == tail ){
+        h ^= static_cast<uint32_t>( static_cast<unsigned char>( str[i+2] ) ) << 16;
+    }
+    if( 2 <= tail ){
+        h ^= static_cast<uint32_t>( static_cast<unsigned char>( str[i+1] ) ) << 8;
+    }
+    if( 1 <= tail ){
+        h ^= static_cast<uint32_t>( static_cast<unsigned char>( str[i] ) );
+        h *= m;
+    }
+
+    h ^= h >> 13;
+    h *= m;
+    h ^= h >> 15;
+    return h;
+}
+
 class Name
 {
 public:
-    Name();
-    Name( const Name& other );  // can copy pending late-init state
-    Name( Name&& source );      // can move pending late-init state
+    Name() = default;
+    Name( const Name& other ) = default;
+    Name( Name&& source ) = default;
     Name( char* const cstr );
     Name( const char* const cstr );
     Name( const std::string& str );
-    virtual ~Name();
+    Name( const NameLiteral& literal );
+    ~Name() = default;
 
-    Name& operator=( const Name& other );
-    Name& operator=( Name&& source );
+    Name& operator=( const Name& other ) = default;
+    Name& operator=( Name&& source ) = default;
     Name& operator=( const std::string& str );
 
     bool operator==( const Name& other ) const;
     bool operator!=( const Name& other ) const;
+    // orders by id (the order of interning), not lexically (see 'NameLexicalLess')
+    //   stable only within the process, empty instances come first
+    bool operator<( const Name& other ) const;
 
     size_t length() const;
 
     const std::string& GetStdString() const;
+    const char* c_str() const;
+    std::string_view GetStringView() const;
     bool IsEmpty() const;
+    // instances are interned at construction, kept for compatibility
     void Init() const;
 
+    // globally unique id of the string, 0 for empty instances
+    uint64_t GetId() const;
+    // 'HashName()' of the string, 0 for empty instances
+    uint32_t GetHash() const;
+    // returns the instance having 'id' (empty instance, if 'id' is unknown)
+    static Name FindById( uint64_t id );
+    // returns the instance of 'str', if it is already interned (empty instance otherwise)
+    //   hashes the bytes in place, doesn't allocate (eg.: for mapping tokens of a parser to names)
+    static Name Find( std::string_view str );
+    // same as constructing from 'str', without needing a null-terminated copy
+    //   only allocates, if 'str' is a new string
+    static Name Intern( std::string_view str );
+
 private:
-    //-------- definitions --------
-    struct NameData{
-        std::string     str;
-        uint64_t        id = 0;
-
-        NameData() = default;
-        NameData( const std::string& str_, uint64_t id_ ):
-            str( str_ ), id( id_ )
-        {}
-    };
-    using NameDataPtr       = std::shared_ptr<       NameData >;
-    using ConstNameDataPtr  = std::shared_ptr< const NameData >;
-
-    //------ static contents ------
-    static uint64_t TakeNextFreeId();
-    static uint64_t TakeNextFreeId_NoLock();
-
-    static const uint32_t   smHashSeed = 0x5f3759df; // note: the seed chosen here had no considerations of any kind
-    static uint64_t         smNextFreeID;            // 0: non-existent | 1+: valid ID
-    static std::mutex       smMutex;
-    static std::unordered_map< uint64_t, ConstNameDataPtr >      smMapById;
-    static std::unordered_multimap< uint32_t, ConstNameDataPtr > smMapByHash;
+    friend bool operator==( const Name& name, const NameLiteral& literal );
 
     //----- private functions -----
-    void CreateSyncedState_( const char* const cstr, size_t length = 0 ) const;
-    void CreatePreInitState_( const char* const cstr );
-    void Init_() const;
-    bool IsInPreInitState_() const;
+    void Intern_( const char* str, size_t length );
+    void Intern_( const char* str, size_t length, uint32_t hash );
+    void Assign_( const NameEntry* entry );
+    const NameEntry* GetEntry_() const;
 
     //------ private members ------
+#ifdef PT_NAME_COMPACT
+    uint32_t            mId     = 0;        // 0:       empty
+                                            // <other>: globally unique string id
+#else
+    const NameEntry*    mEntry  = nullptr;  // nullptr: empty
+    uint64_t            mId     = 0;        // redundant storage, prevents cache-miss on comparisons
+                                            // 0:       empty
+                                            // <other>: globally unique string id
+#endif
+};
 
-    // pending late-init: The instance holds the string data by itself,
-    //                    but is not sync-ed globally yet (has no global id or proper ref-count).
 
-    mutable ConstNameDataPtr mData;   // While pending late-init, this holds the non-unique string data.
-                                      // While initialized, it provides direct access to the unique string data.
-    mutable uint64_t         mId = 0; // redundant storage, prevents cache-miss and race-conditions
-                                      // 0:          empty
-                                      // UINT64_MAX: pending late-init
-                                      // <other>:    globally unique string id
+// 4-byte handle of a 'pt::Name' (its id), for large arrays of names
+//   trivially copyable, the string is resolved through the global id table in O(1)
+class NameId
+{
+public:
+    NameId() = default;
+    NameId( const Name& name ):
+        mId( static_cast<uint32_t>( name.GetId() ) )
+    {}
+    NameId( const char* const cstr ):
+        NameId( Name( cstr ) )
+    {}
+    NameId( const std::string& str ):
+        NameId( Name( str ) )
+    {}
+
+    bool operator==( const NameId& other ) const{
+        return ( 0 != mId ) && ( mId == other.mId );
+    }
+    bool operator!=( const NameId& other ) const{
+        return !this->operator==( other );
+    }
+    bool operator<( const NameId& other ) const{
+        return mId < other.mId;
+    }
+
+    Name GetName() const{
+        return Name::FindById( mId );
+    }
+    const char* c_str() const{
+        return GetName().c_str();
+    }
+    bool IsEmpty() const{
+        return 0 == mId;
+    }
+    uint32_t GetId() const{
+        return mId;
+    }
+
+private:
+    uint32_t mId = 0;
 };
 
+// lexical (string) ordering of names, eg.: for sorted output
+//   slower than the id-based 'operator<', but doesn't allocate
+struct NameLexicalLess
+{
+    bool operator()( const Name& lhs, const Name& rhs ) const{
+        return lhs.GetStringView() < rhs.GetStringView();
+    }
+};
+
+
+// a string literal with its hash computed at compile time, see '"AssetName"_name'
+//   converting it to 'pt::Name' interns the string without hashing it
+class NameLiteral
+{
+public:
+    constexpr NameLiteral( const char* str, size_t length ):
+        mStr( str ), mLength( length ), mHash( HashName( str, length ) )
+    {}
+
+    constexpr const char* c_str() const{
+        return mStr;
+    }
+    constexpr size_t length() const{
+        return mLength;
+    }
+    constexpr uint32_t GetHash() const{
+        return mHash;
+    }
+
+private:
+    const char* mStr;
+    size_t      mLength;
+    uint32_t    mHash;
+};
+
+// compares the stored string with the literal, doesn't intern it
+//   false for empty instances, same as comparing with 'pt::Name( literal )'
+bool operator==( const Name& name, const NameLiteral& literal );
+
+inline bool operator==( const NameLiteral& literal, const Name& name ){
+    return name == literal;
+}
+inline bool operator!=( const Name& name, const NameLiteral& literal ){
+    return !( name == literal );
+}
+inline bool operator!=( const NameLiteral& literal, const Name& name ){
+    return !( name == literal );
+}
+
+
+namespace literals{
+
+constexpr NameLiteral
+operator"" _name( const char* str, size_t length )
+{
+    return NameLiteral( str, length );
+}
+
+} // end of namespace 'literals'
+
+
+static_assert( std::is_trivially_copyable<Name>::value, "pt::Name has to be trivially copyable" );
+static_assert( std::is_trivially_copyable<NameId>::value && ( 4 == sizeof(NameId) ), "pt::NameId has to be a trivially copyable 32-bit value" );
+#ifdef PT_NAME_COMPACT
+static_assert( 4 == sizeof(Name), "pt::Name has to be a 32-bit value in compact mode" );
+#endif
+
 } // end of namespace 'pt'
 
+// interns the string literal 'str' once per call site, its hash is computed at compile time
+//   'str' is concatenated with the literal operator, so anything else than a string literal fails to compile
+#define PT_NAME( str ) \
+    ( []() -> const pt::Name& { \
+        using namespace pt::literals; \
+        static constexpr pt::NameLiteral __pt_literal = str ""_name; \
+        static const pt::Name __pt_name( __pt_literal ); \
+        return __pt_name; \
+    }() )
+
 std::ostream& operator<<( std::ostream& os, const pt::Name& obj );
 
+// hashes the id, not the string (values differ between processes)
 template<> struct std::hash<pt::Name> {
     std::size_t operator()( pt::Name const& name ) const noexcept {
-        return std::hash<std::string>{}( name.GetStdString() );
+        return std::hash<uint64_t>{}( name.GetId() );
+    }
+};
+
+template<> struct std::hash<pt::NameId> {
+    std::size_t operator()( pt::NameId const& id ) const noexcept {
+        return std::hash<uint32_t>{}( id.GetId() );
     }
 };
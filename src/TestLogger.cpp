@@ -1,5 +1,31 @@
 #include "TestLogger.hpp"
 
+#include "pt/def.h"
+#include "pt/log/compress.h"
+#include "pt/log/filesink.h"
+#include "pt/log/mappedfilesink.h"
+#include "pt/log/shmring.h"
+#include "pt/log/timestamp.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef PT_PLATFORM_LINUX
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 
 bool TestLogger::
 run()
@@ -41,9 +67,27 @@ run()
         pt::log::out << "\n";
 
         pt::log::out << "testing hungarian special characters: árvíztűrő tükörfúrógép\n";
+
+        testConcurrentLogging();
+
+        // drains the queue, the following tests log synchronously
+        pt::log::Destroy();
+        success = testSinks();
+        success &= testBinaryLogging();
+        success &= testContainerLogging();
+        success &= testKeyValueLogging();
+        success &= testLimitedLogging();
+        success &= testCategories();
+        success &= testRotation();
+        success &= testTimestamps();
+        success &= testOverflowPolicies();
+        success &= testCrashHandler();
+        success &= testDaemonRing();
+        success &= testMappedFile();
+        success &= testLogTool();
         std::cout << "--------------------------------------------------\n";
 
-        return true;
+        return success;
     }catch(const std::exception& e){
         std::cout << "Failed to initialize logger: " << e.what() << "\n";
         return false;
@@ -55,6 +99,902 @@ run()
 }
 
 
+void TestLogger::
+testConcurrentLogging( size_t thread_count, size_t message_count )
+{
+    std::vector<std::thread> threads;
+    for( size_t t=0; t<thread_count; ++t ){
+        threads.push_back( std::thread( [t, message_count](){
+            for( size_t i=0; i<message_count; ++i ){
+                PT_LOG_INFO( "testing concurrent logging: thread(" << t << ") message(" << i << ")" );
+            }
+        } ) );
+    }
+    for( auto& thread : threads ){
+        thread.join();
+    }
+}
+
+
+// runs without the writer thread, every record is decoded synchronously
+//   checks the expansion of '{}', the extra and missing arguments and the names resolved from their ids
+bool TestLogger::
+testBinaryLogging()
+{
+    auto memory = std::make_shared<pt::log::MemorySink>();
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ memory } );
+    pt::log::BindSinks( pt::log::warn, pt::log::SinkList{ memory } );
+    pt::log::SetTimestamps( false );
+
+    static const pt::Name name( "binary_name" );
+    const pt::Name runtime_name( std::string( "binary_runtime_" ) + std::to_string( 7 ) );
+    std::string str( "std::string" );
+    PT_LOG_BINARY_INFO( "testing binary logging: int({}) uint({}) double({}) char({}) bool({})",
+                        -42, 42u, 3.25, 'c', true );
+    PT_LOG_BINARY_INFO( "testing binary logging: cstr({}) str({}) name({}) runtime name({})",
+                        "literal", str, name, runtime_name );
+    PT_LOG_BINARY_WARN( "testing binary logging: extra arguments:", 1, 2, 3 );
+    PT_LOG_BINARY_INFO( "testing binary logging: no arguments" );
+    PT_LOG_BINARY_INFO( "testing binary logging: missing({}) arguments({})", 1 );
+
+    pt::log::SetTimestamps( true );
+    pt::log::ResetSinks( pt::log::out );
+    pt::log::ResetSinks( pt::log::warn );
+
+    const std::string expected =
+        "Log: testing binary logging: int(-42) uint(42) double(3.25) char(c) bool(1)\n"
+        "Log: testing binary logging: cstr(literal) str(std::string) name(binary_name) runtime name(binary_runtime_7)\n"
+        "Warning: WARNING: testing binary logging: extra arguments: 1 2 3\n"
+        "Log: testing binary logging: no arguments\n"
+        "Log: testing binary logging: missing(1) arguments({})\n";
+    const bool success = ( expected == memory->GetContents() );
+
+    std::cout << "binary logging test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    if( !success ){
+        memory->Dump( std::cout );
+    }
+    return success;
+}
+
+
+// runs without the writer thread, every record is written synchronously
+//   a memory sink, that only has room for the last 3 lines, has to keep those (oldest first)
+bool TestLogger::
+testSinks()
+{
+    const size_t message_count = 8;
+    const size_t kept_count    = 3;
+    auto all = std::make_shared<pt::log::MemorySink>();
+    pt::log::SetTimestamps( false );
+
+    // the lines have the same length, the capacity has room for 3.5 of them
+    const std::string line = "Warning: WARNING: testing memory sink: message(0)\n";
+    auto memory = std::make_shared<pt::log::MemorySink>( kept_count * line.length() + line.length() / 2 );
+    pt::log::RegisterSink( "test_memory", memory );
+    pt::log::RegisterSink( "test_memory_all", all );
+    const bool bound = pt::log::BindSinks( pt::log::warn, std::vector<std::string>{ "test_memory", "test_memory_all" } );
+    std::string expected_all;
+    std::string expected_kept;
+    for( size_t i=0; i<message_count; ++i ){
+        PT_LOG_WARN( "testing memory sink: message(" << i << ")" );
+        const std::string expected_line = "Warning: WARNING: testing memory sink: message(" + std::to_string( i ) + ")\n";
+        expected_all += expected_line;
+        if( message_count - kept_count <= i ){
+            expected_kept += expected_line;
+        }
+    }
+    pt::log::ResetSinks( pt::log::warn );
+
+    bool success = bound && ( expected_all == all->GetContents() ) && ( expected_kept == memory->GetContents() );
+    memory->Clear();
+    success &= memory->GetContents().empty();
+
+    // records of a stream bound to the null sink reach no other sink
+    all->Clear();
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ all } );
+    PT_LOG_INFO( "testing null sink: before" );
+    pt::log::BindSinks( pt::log::out, {"null"} );
+    PT_LOG_INFO( "testing null sink: this message should not appear anywhere" );
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ all } );
+    PT_LOG_INFO( "testing null sink: after" );
+    pt::log::ResetSinks( pt::log::out );
+    pt::log::SetTimestamps( true );
+    success &= ( "Log: testing null sink: before\nLog: testing null sink: after\n" == all->GetContents() );
+
+    std::cout << "sink test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    if( !success ){
+        memory->Dump( std::cout );
+        all->Dump( std::cout );
+    }
+    return success;
+}
+
+
+// runs without the writer thread, every record is written synchronously
+bool TestLogger::
+testContainerLogging()
+{
+    auto memory = std::make_shared<pt::log::MemorySink>();
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ memory } );
+    pt::log::SetTimestamps( false );
+    const size_t max_elements = pt::log::logstream::getMaxElements();
+    pt::log::logstream::setMaxElements( 4 );
+
+    const std::vector<int>      list = { 1, 2, 3, 4, 5, 6 };
+    const std::array<double, 2> pair = { 0.5, 1.5 };
+    const char                  letters[] = { 'a', 'b', 'c' };
+    std::ostringstream oss;
+    oss << "spliced " << 42;
+    std::stringstream  empty;
+    std::stringstream  readable( "read 7" );
+    std::stringstream  consumed( "[abc]" );
+    std::stringstream  partial( "skipped rest" );
+    std::string        word;
+    consumed >> word;
+    partial >> word;
+
+    PT_LOG_INFO( list );
+    PT_LOG_INFO( pair << " " << pt::log::MakeSpan( letters, 3 ) << " " << std::vector<int>() );
+    PT_LOG_INFO( oss.rdbuf() << " " << readable.rdbuf() << " " << empty.rdbuf() << "after empty" );
+    PT_LOG_INFO( "consumed(" << consumed.rdbuf() << ") partial(" << partial.rdbuf() << ")" );
+
+    pt::log::logstream::setMaxElements( max_elements );
+    pt::log::SetTimestamps( true );
+    pt::log::ResetSinks( pt::log::out );
+
+    const std::string expected = "Log: [1, 2, 3, 4, ...and 2 more]\n"
+                                 "Log: [0.5, 1.5] [a, b, c] []\n"
+                                 "Log: spliced 42 read 7 after empty\n"
+                                 "Log: consumed() partial( rest)\n";
+    const bool success = ( expected == memory->GetContents() );
+    std::cout << "container logging test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    if( !success ){
+        std::cout << memory->GetContents();
+    }
+    return success;
+}
+
+
+// categories switched by a settings file, only the enabled ones reach the sink
+bool TestLogger::
+testCategories()
+{
+    const std::string path = "./category_test.conf";
+    {
+        std::ofstream settings( path );
+        settings << "# test settings\n"
+                 << "category.* = off\n"
+                 << "category.test_net = on   # only this one\n"
+                 << "stream.debug = on\n";
+    }
+    auto memory = std::make_shared<pt::log::MemorySink>();
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ memory } );
+    pt::log::SetTimestamps( false );
+    pt::log::SetSettingsFile( path );
+    pt::log::LoadSettings();
+
+    int evaluated = 0;
+    PT_LOG_CAT_INFO( "test_net", "connected " << ++evaluated );
+    PT_LOG_CAT_INFO( "test_disk", "written " << ++evaluated );
+    pt::log::SetCategoryEnabled( "test_disk", true );
+    PT_LOG_CAT_INFO( "test_disk", "written " << ++evaluated );
+
+    pt::log::SetSettingsFile( "" );
+    pt::log::Category::SetAllEnabled( true );
+    pt::log::SetTimestamps( true );
+    pt::log::ResetSinks( pt::log::out );
+    std::remove( path.c_str() );
+
+    const std::string expected = "Log: [test_net] connected 1\n"
+                                 "Log: [test_disk] written 2\n";
+    const bool success = ( expected == memory->GetContents() ) && ( 2 == evaluated );
+    std::cout << "category test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    if( !success ){
+        std::cout << memory->GetContents();
+    }
+    return success;
+}
+
+
+// writes ~2KB into a sink rotating at 256 bytes, keeping the last 2 compressed files
+//   the rotated files of an earlier run count into the retention too
+bool TestLogger::
+testRotation()
+{
+    const std::string path = "./rotation_test.txt";
+    pt::log::RotationSettings rotation;
+    rotation.maxFileSize     = 256;
+    rotation.maxRotatedFiles = 2;
+    rotation.compress        = true;
+
+    // leftovers of earlier runs
+    std::remove( path.c_str() );
+    for( size_t i=1; i<=64; ++i ){
+        std::string rotated = path + "." + std::to_string( i );
+        std::remove( rotated.c_str() );
+        std::remove( ( rotated + pt::log::CompressedFileExtension ).c_str() );
+    }
+    // the earlier run left a gap in the indices ('.1' and '.2' are free)
+    const std::string unrelated_path = path + ".1x";
+    const size_t earlier_last_index = 4;
+    std::ofstream( path + ".3" ) << "earlier run\n";
+    std::ofstream( path + ".4" + pt::log::CompressedFileExtension ) << "earlier run\n";
+    std::ofstream( unrelated_path ) << "not a rotated file\n";
+
+    std::vector<std::string> lines;
+    auto write_lines = [&]( size_t count ){
+        pt::log::FileSink sink;
+        sink.SetRotation( rotation );
+        if( !sink.Open( path ) ){
+            std::cout << "rotation test: failed to open '" << path << "'\n";
+            return false;
+        }
+        for( size_t i=0; i<count; ++i ){
+            lines.push_back( "testing rotation: line(" + std::to_string( lines.size() ) + ")\n" );
+            sink.Write( lines.back() );
+        }
+        sink.Close();
+        pt::log::GetRotationWorker().WaitIdle();
+        return true;
+    };
+    // returns the highest index, that is kept
+    auto check_retention = [&]( size_t min_index, bool& success ){
+        size_t rotated_count = 0;
+        size_t last_index    = 0;
+        for( size_t i=1; i<=64; ++i ){
+            const std::string rotated = path + "." + std::to_string( i );
+            const bool found = std::ifstream( rotated ).good()
+                               || std::ifstream( rotated + pt::log::CompressedFileExtension ).good();
+            rotated_count += found ? 1 : 0;
+            last_index     = found ? i : last_index;
+            success &= !found || ( min_index < i );
+        }
+        success &= ( rotation.maxRotatedFiles == rotated_count );
+        return last_index;
+    };
+
+    // only the newest 2 rotated files are kept, the ones of the earlier run are deleted
+    //   the indices continue after the earlier run, the free low ones aren't reused
+    bool retention_success = write_lines( 64 );
+    const size_t first_last_index = check_retention( earlier_last_index, retention_success );
+    retention_success &= std::ifstream( unrelated_path ).good();
+    std::remove( unrelated_path.c_str() );
+    // a restarted sink rotating once has to keep its own rotated file (the newest)
+    retention_success &= write_lines( 9 );
+    retention_success &= ( first_last_index < check_retention( first_last_index - 1, retention_success ) );
+
+    // the current file and the last rotated one have to continue each other
+    std::string newest_rotated;
+    for( size_t i=64; 0 < i; --i ){
+        std::string rotated = path + "." + std::to_string( i ) + pt::log::CompressedFileExtension;
+        if( std::ifstream( rotated ).good() ){
+            newest_rotated = rotated;
+            break;
+        }
+    }
+    std::string decompressed_path = path + ".decompressed";
+    bool success = retention_success && ( 0 < newest_rotated.length() )
+                   && pt::log::DecompressFile( newest_rotated, decompressed_path );
+
+    std::stringstream contents;
+    contents << std::ifstream( decompressed_path ).rdbuf() << std::ifstream( path ).rdbuf();
+    std::string expected_end;
+    for( const auto& line : lines ){
+        expected_end += line;
+    }
+    const std::string text = contents.str();
+    success = success && ( 0 < text.length() ) && ( text.length() < expected_end.length() )
+              && ( 0 == expected_end.compare( expected_end.length() - text.length(), text.length(), text ) );
+
+    std::cout << "rotation test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    std::remove( decompressed_path.c_str() );
+    return success;
+}
+
+
+namespace{
+
+// keeps the queue full, records the written messages (only read after the writer stopped)
+class SlowCountingSink: public pt::log::Sink
+{
+public:
+    void Write( const pt::log::LogRecord& record ) override{
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+        texts.push_back( record.text );
+        ++count;
+    }
+    std::atomic<size_t>         count{ 0 };
+    std::vector<std::string>    texts;
+};
+
+// the messages of each thread have to be written in the order of logging: out(0), err(0), out(1), ...
+bool
+IsOverflowOrderKept( const std::vector<std::string>& texts, size_t thread_count )
+{
+    std::vector<int> last( thread_count, -1 );
+    for( const auto& text : texts ){
+        // severity macros may prefix the message
+        const size_t start = text.find( "testing overflow: " );
+        char   stream[4] = {};
+        size_t thread    = 0;
+        int    index     = 0;
+        if( ( std::string::npos == start )
+            || ( 3 != sscanf( text.c_str() + start, "testing overflow: %3s message(%zu, %d)", stream, &thread, &index ) )
+            || ( thread_count <= thread ) )
+        {
+            std::cout << "unexpected message: " << text;
+            return false;
+        }
+        const int position = 2 * index + ( ( std::string( "err" ) == stream ) ? 1 : 0 );
+        if( position <= last[thread] ){
+            std::cout << "out of order: " << text;
+            return false;
+        }
+        last[thread] = position;
+    }
+    return true;
+}
+
+} //end of anonymous namespace
+
+
+// floods a tiny queue through a slow sink: 'out' has to drop, 'err' must not
+//   runs with both dropping policies of 'out', written records have to keep their order
+bool TestLogger::
+testOverflowPolicies()
+{
+    const size_t thread_count  = 4;
+    const size_t message_count = 200;
+    bool success = true;
+
+    for( auto policy : { pt::log::OverflowPolicy::DropNewest, pt::log::OverflowPolicy::DropOldest } ){
+        auto sink = std::make_shared<SlowCountingSink>();
+
+        pt::log::SetQueueCapacity( 16 );
+        pt::log::Initialize( "./", pt::log::AutoGenerateLogFileName() );
+        pt::log::BindSinks( pt::log::out, pt::log::SinkList{ sink } );
+        pt::log::BindSinks( pt::log::err, pt::log::SinkList{ sink } );
+        pt::log::out.setOverflowPolicy( policy );
+        const uint64_t out_dropped_before = pt::log::out.getDroppedCount();
+        const uint64_t err_dropped_before = pt::log::err.getDroppedCount();
+
+        std::vector<std::thread> threads;
+        for( size_t t=0; t<thread_count; ++t ){
+            threads.push_back( std::thread( [message_count, t](){
+                for( size_t i=0; i<message_count; ++i ){
+                    PT_LOG_INFO( "testing overflow: out message(" << t << ", " << i << ")" );
+                    PT_LOG_ERR( "testing overflow: err message(" << t << ", " << i << ")" );
+                }
+            } ) );
+        }
+        for( auto& thread : threads ){
+            thread.join();
+        }
+        pt::log::Destroy();
+        pt::log::out.setOverflowPolicy( pt::log::OverflowPolicy::DropNewest );
+        pt::log::ResetSinks( pt::log::out );
+        pt::log::ResetSinks( pt::log::err );
+        pt::log::SetQueueCapacity( 8192 );
+
+        const uint64_t out_dropped = pt::log::out.getDroppedCount() - out_dropped_before;
+        const uint64_t err_dropped = pt::log::err.getDroppedCount() - err_dropped_before;
+        const size_t   total = 2 * thread_count * message_count;
+        const bool     ordered = IsOverflowOrderKept( sink->texts, thread_count );
+        const bool     policy_success = ( 0 < out_dropped ) && ( 0 == err_dropped )
+                                        && ( sink->count == total - out_dropped ) && ordered;
+
+        std::cout << "overflow test (" << ( pt::log::OverflowPolicy::DropOldest == policy ? "DropOldest" : "DropNewest" )
+                  << "): out dropped(" << out_dropped << ") err dropped(" << err_dropped
+                  << ") written(" << sink->count << "/" << total << ") ordered(" << ( ordered ? "yes" : "no" ) << ") "
+                  << ( policy_success ? "SUCCESS" : "FAILURE" ) << "\n";
+        success &= policy_success;
+    }
+    return success;
+}
+
+
+// a forked child logs into a large, never flushed buffer and crashes
+//   every message and the stack trace have to reach the file anyway
+bool TestLogger::
+testCrashHandler()
+{
+    #ifdef PT_PLATFORM_LINUX
+    const std::string filename = "crash_test.txt";
+    const size_t message_count = 100;
+    std::remove( ("./" + filename).c_str() );
+
+    pid_t pid = fork();
+    if( 0 == pid ){
+        pt::log::SetFileBufferSize( 1024 * 1024 );
+        pt::log::SetFlushInterval( 0 );
+        pt::log::SetFlushOnSend( false );
+        if( !pt::log::Initialize( "./", filename ) ){
+            _exit( 1 );
+        }
+        pt::log::BindSinks( pt::log::out, {"file"} );
+        for( size_t i=0; i<message_count; ++i ){
+            PT_LOG_INFO( "testing crash handler: message(" << i << ")" );
+        }
+        raise( SIGSEGV );
+        _exit( 1 );
+    }
+
+    int status = 0;
+    bool success = ( 0 < pid ) && ( pid == waitpid( pid, &status, 0 ) )
+                   && WIFSIGNALED( status ) && ( SIGSEGV == WTERMSIG( status ) );
+
+    std::ifstream file( "./" + filename );
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+    for( size_t i=0; i<message_count; ++i ){
+        success &= ( std::string::npos != text.find( "message(" + std::to_string( i ) + ")\n" ) );
+    }
+    success &= ( std::string::npos != text.find( "ptlib: stack trace:" ) );
+
+    std::cout << "crash handler test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    return success;
+    #else
+    return true;
+    #endif
+}
+
+
+// concurrent writers crossing many small windows, then appending to the trimmed file again
+bool TestLogger::
+testMappedFile()
+{
+    #ifdef PT_PLATFORM_LINUX
+    const std::string path = "./mapped_test.txt";
+    const size_t message_count = 2000;
+    std::remove( path.c_str() );
+
+    // a small window, that moves many times, the second pass appends to the first one
+    std::string expected;
+    size_t expected_length = 0;
+    for( size_t pass=0; pass<2; ++pass ){
+        pt::log::MappedFileSink sink;
+        if( !sink.Open( path, 4096 ) ){
+            std::cout << "mapped file test: FAILURE (open)\n";
+            return false;
+        }
+        for( size_t i=0; i<message_count; ++i ){
+            const std::string line = "pass(" + std::to_string( pass ) + ") message(" + std::to_string( i ) + ")\n";
+            sink.Write( line );
+            expected += line;
+        }
+        expected_length = sink.GetWrittenLength();
+    }
+
+    std::ifstream file( path, std::ios::binary );
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+    const size_t line_count = std::count( text.begin(), text.end(), '\n' );
+    const bool success = ( expected == text ) && ( expected_length == text.length() );
+
+    std::cout << "mapped file test: lines(" << line_count << ") " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    return success;
+    #else
+    return true;
+    #endif
+}
+
+
+// runs the 'ptlib_log' query tool (built next to the test executable) on generated log files
+bool TestLogger::
+testLogTool()
+{
+    #ifdef PT_PLATFORM_LINUX
+    char exe_path[4096];
+    const ssize_t exe_length = readlink( "/proc/self/exe", exe_path, sizeof(exe_path) - 1 );
+    if( exe_length <= 0 ){
+        std::cout << "log tool test: FAILURE (executable path)\n";
+        return false;
+    }
+    std::string tool( exe_path, exe_length );
+    tool = tool.substr( 0, tool.rfind( '/' ) + 1 ) + "ptlib_log";
+    if( 0 != access( tool.c_str(), X_OK ) ){
+        std::cout << "log tool test: FAILURE ('" << tool << "' not found)\n";
+        return false;
+    }
+
+    // returns the exit code, 'output' gets the standard output
+    auto run_tool = [&tool]( const std::vector<std::string>& args, std::string& output ){
+        std::string command = "'" + tool + "'";
+        for( const auto& arg : args ){
+            command += " '" + arg + "'";
+        }
+        command += " 2>/dev/null";
+        output.clear();
+        FILE* pipe = popen( command.c_str(), "r" );
+        if( nullptr == pipe ){
+            return -1;
+        }
+        char buffer[4096];
+        size_t count;
+        while( 0 < ( count = fread( buffer, 1, sizeof(buffer), pipe ) ) ){
+            output.append( buffer, count );
+        }
+        const int status = pclose( pipe );
+        return WIFEXITED( status ) ? WEXITSTATUS( status ) : -1;
+    };
+    auto expect = [&run_tool]( const std::vector<std::string>& args, const std::string& expected ){
+        std::string output;
+        return ( 0 == run_tool( args, output ) ) && ( expected == output );
+    };
+
+    // timestamped lines, a continuation line and a JSON line of a key-value record
+    const std::string path = "./logtool_test.txt";
+    const std::vector<std::string> lines = {
+        "2026-10-18 06:59:59.500 Log: before the hour",
+        "2026-10-18 07:00:00.000 Warning: disk almost full",
+        "2026-10-18 07:15:30.250 ERROR: connection timeout",
+        "    retried 3 times",
+        "{\"time\":\"2026-10-18 07:30:00.000\",\"stream\":\"Warning\",\"event\":\"slow timeout\"}",
+        "2026-10-18 07:59:59.999 Log: end of the hour",
+        "2026-10-18 08:00:00.000 ERROR: next hour timeout",
+    };
+    auto join = [&lines]( std::initializer_list<size_t> indices ){
+        std::string text;
+        for( size_t i : indices ){
+            text += lines[i] + "\n";
+        }
+        return text;
+    };
+    {
+        std::ofstream file( path, std::ios::binary | std::ios::trunc );
+        file << join( { 0, 1, 2, 3, 4, 5, 6 } );
+    }
+
+    std::string output;
+    bool success = true;
+    // argument parsing
+    success &= ( 1 == run_tool( {}, output ) ) && ( 0 == output.compare( 0, 6, "usage:" ) );
+    success &= ( 1 == run_tool( { path, "bogus=1" }, output ) );
+    success &= ( 1 == run_tool( { "./logtool_missing.txt" }, output ) );
+    success &= expect( { path, "count" }, "7\n" );
+    // level and substring filters, the continuation line belongs to its record
+    success &= expect( { path, "level=ERROR" }, join( { 2, 3, 6 } ) );
+    success &= expect( { path, "level=Warning" }, join( { 1, 4 } ) );
+    success &= expect( { path, "contains=timeout" }, join( { 2, 4, 6 } ) );
+    success &= expect( { path, "level=Warning,ERROR", "contains=timeout" }, join( { 2, 4, 6 } ) );
+    success &= expect( { path, "contains=retried" }, join( { 3 } ) );
+    // time bounds, partial timestamps cover the whole period
+    success &= expect( { path, "from=2026-10-18 07", "to=2026-10-18 07" }, join( { 1, 2, 3, 4, 5 } ) );
+    success &= expect( { path, "from=2026-10-18 07:15:30.250", "to=2026-10-18 07:30" }, join( { 2, 3, 4 } ) );
+    success &= expect( { path, "to=2026-10-18 06:59:59" }, join( { 0 } ) );
+    success &= expect( { path, "from=2026-10-18 07:30", "level=Warning" }, join( { 4 } ) );
+    // compressed rotated files, the matches of several files are labeled
+    const std::string compressed_path = path + pt::log::CompressedFileExtension;
+    success &= pt::log::CompressFile( path, compressed_path );
+    success &= expect( { compressed_path, "level=ERROR", "count" }, "3\n" );
+    success &= expect( { path, compressed_path, "contains=next hour" },
+                       path + ":" + lines[6] + "\n" + compressed_path + ":" + lines[6] + "\n" );
+
+    // time index: a record moved early into a large file is only found without the index,
+    //   the index query seeks past it
+    const std::string large_path = "./logtool_index_test.txt";
+    const std::string index_path = large_path + ".ptidx";
+    const size_t line_count = 60000;
+    size_t line_length = 0;
+    {
+        std::ofstream file( large_path, std::ios::binary | std::ios::trunc );
+        for( size_t i=0; i<line_count; ++i ){
+            char line[128];
+            line_length = snprintf( line, sizeof(line), "2026-10-18 09:%02u:%02u.%03u Log: indexed message(%06u)\n",
+                                    unsigned( i / 60000 ), unsigned( i / 1000 % 60 ), unsigned( i % 1000 ), unsigned( i ) );
+            file << line;
+        }
+    }
+    std::remove( index_path.c_str() );
+    const std::vector<std::string> range_query = { large_path, "from=2026-10-18 09:00:45", "to=2026-10-18 09:00:45", "count" };
+    success &= expect( range_query, "1000\n" );
+    success &= ( 0 == run_tool( { large_path, "index" }, output ) );
+    std::ifstream index_file( index_path, std::ios::binary | std::ios::ate );
+    success &= index_file.is_open() && ( 0 < index_file.tellg() );
+    index_file.close();
+    {
+        std::fstream file( large_path, std::ios::binary | std::ios::in | std::ios::out );
+        file.seekp( 100 * line_length + 14 );
+        file << "00:45";
+    }
+    success &= expect( range_query, "1000\n" );
+    std::remove( index_path.c_str() );
+    success &= expect( range_query, "1001\n" );
+
+    std::remove( path.c_str() );
+    std::remove( compressed_path.c_str() );
+    std::remove( large_path.c_str() );
+
+    std::cout << "log tool test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    return success;
+    #else
+    return true;
+    #endif
+}
+
+
+// a child process attaches to a small ring and writes records of varying size (wrapping many times),
+//   the parent consumes them like the logger daemon and checks their order and contents
+bool TestLogger::
+testDaemonRing()
+{
+    #ifdef PT_PLATFORM_LINUX
+    const std::string name = "/ptlib_test_ring_" + std::to_string( getpid() );
+    const size_t record_count = 2000;
+    auto make_record = []( size_t i ){
+        return "record(" + std::to_string( i ) + ")" + std::string( i % 97, 'x' );
+    };
+
+    pt::log::SharedMemoryRing daemon;
+    if( !daemon.Create( name, 4096 ) ){
+        std::cout << "daemon ring test: FAILURE (create)\n";
+        return false;
+    }
+    daemon.UpdateHeartbeat();
+
+    // an empty ring has to sleep in 'Wait()', not spin
+    const auto wait_start = std::chrono::steady_clock::now();
+    daemon.Wait( 50 );
+    const auto waited = std::chrono::steady_clock::now() - wait_start;
+    bool success = ( std::chrono::milliseconds( 40 ) <= waited );
+
+    pid_t pid = fork();
+    if( 0 == pid ){
+        pt::log::SharedMemoryRing client;
+        if( !client.Attach( name, 1000 ) ){
+            _exit( 1 );
+        }
+        for( size_t i=0; i<record_count; ++i ){
+            const std::string record = make_record( i );
+            while( !client.TryWrite( record.data(), record.length() ) ){
+                client.Notify();
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            }
+            client.Notify();
+        }
+        _exit( 0 );
+    }
+
+    size_t received = 0;
+    auto on_record = [&]( const char* data, size_t length ){
+        success &= ( make_record( received ) == std::string( data, length ) );
+        ++received;
+    };
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+    while( ( received < record_count ) && ( std::chrono::steady_clock::now() < deadline ) ){
+        daemon.UpdateHeartbeat();
+        if( 0 == daemon.Consume( on_record, 64 ) ){
+            daemon.Wait( 10 );
+        }
+    }
+
+    int status = 0;
+    success &= ( 0 < pid ) && ( pid == waitpid( pid, &status, 0 ) )
+               && WIFEXITED( status ) && ( 0 == WEXITSTATUS( status ) );
+    success &= ( record_count == received );
+    daemon.Close();
+
+    std::cout << "daemon ring test: records(" << received << "/" << record_count << ") "
+              << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    return success;
+    #else
+    return true;
+    #endif
+}
+
+
+// the cached formatter has to match 'std::put_time()', also after the second changes
+bool TestLogger::
+testTimestamps()
+{
+    pt::log::TimestampFormatter formatter;
+    const int64_t base = pt::log::GetTimestamp() / 1000000000 * 1000000000;
+    const int64_t offsets_ms[] = { 0, 7, 999, 1000, 1042, 61001 };
+
+    bool success = true;
+    for( int64_t offset : offsets_ms ){
+        const int64_t timestamp = base + offset * 1000000;
+        char formatted[pt::log::TimestampFormatter::Length];
+        formatter.Format( timestamp, formatted );
+
+        std::time_t seconds = static_cast<std::time_t>( timestamp / 1000000000 );
+        std::stringstream expected;
+        expected << std::put_time( std::localtime( &seconds ), "%Y-%m-%d %H:%M:%S" )
+                 << "." << std::setw( 3 ) << std::setfill( '0' ) << ( offset % 1000 );
+        success &= ( expected.str() == std::string( formatted, sizeof(formatted) ) );
+    }
+
+    std::cout << "timestamp test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    return success;
+}
+
+
+// runs without the writer thread, every record is written synchronously
+//   every call site is called 'thread_count * message_count' times, the written lines are counted
+bool TestLogger::
+testLimitedLogging( size_t thread_count, size_t message_count )
+{
+    auto memory = std::make_shared<pt::log::MemorySink>();
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ memory } );
+    pt::log::BindSinks( pt::log::warn, pt::log::SinkList{ memory } );
+    pt::log::SetTimestamps( false );
+
+    std::vector<std::thread> threads;
+    for( size_t t=0; t<thread_count; ++t ){
+        threads.push_back( std::thread( [t, message_count](){
+            for( size_t i=0; i<message_count; ++i ){
+                PT_LOG_ONCE_INFO( "testing once logging: thread(" << t << ") message(" << i << ")" );
+                PT_LOG_LIMITED_WARN( 3, "testing limited logging: thread(" << t << ") message(" << i << ")" );
+                PT_LOG_RATE_LIMITED_INFO( 2, "testing rate limited logging: thread(" << t << ") message(" << i << ")" );
+                PT_LOG_SAMPLED_INFO( 64, "testing sampled logging: thread(" << t << ") message(" << i << ")" );
+                PT_LOG_SAMPLED_RANDOM_INFO( 16, "testing random sampled logging: thread(" << t << ") message(" << i << ")" );
+            }
+        } ) );
+    }
+    for( auto& thread : threads ){
+        thread.join();
+    }
+
+    // the suppressed count is reported by the first message of the next window
+    for( size_t i=0; i<100; ++i ){
+        if( 99 == i ){
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1100 ) );
+        }
+        PT_LOG_RATE_LIMITED_INFO( 2, "testing rate limit window: message(" << i << ")" );
+    }
+    // every sampled call reports the calls skipped before it
+    for( size_t i=0; i<200; ++i ){
+        PT_LOG_SAMPLED_INFO( 64, "testing sample skips: message(" << i << ")" );
+    }
+
+    pt::log::SetTimestamps( true );
+    pt::log::ResetSinks( pt::log::out );
+    pt::log::ResetSinks( pt::log::warn );
+
+    const size_t calls = thread_count * message_count;
+    size_t once = 0, limited = 0, limit_notes = 0, rated = 0, sampled = 0, random_sampled = 0;
+    uint64_t rate_suppressed = 0, sampled_skipped = 0, random_skipped = 0;
+    std::vector<std::string> window_lines;
+    std::vector<std::string> skip_lines;
+    std::stringstream contents( memory->GetContents() );
+    std::string line;
+    bool success = true;
+    while( std::getline( contents, line ) ){
+        unsigned long long count = 0;
+        const size_t skipped_pos = line.find( ", skipped " );
+        if( std::string::npos != skipped_pos ){
+            success &= ( 1 == sscanf( line.c_str() + skipped_pos, ", skipped %llu]", &count ) );
+        }
+        if( std::string::npos != line.find( "testing once logging:" ) ){
+            ++once;
+        }else if( std::string::npos != line.find( "testing limited logging:" ) ){
+            ++limited;
+        }else if( std::string::npos != line.find( "Limit(3) reached." ) ){
+            ++limit_notes;
+        }else if( std::string::npos != line.find( "testing rate limited logging:" ) ){
+            ++rated;
+        }else if( std::string::npos != line.find( "Rate limit(2/s) suppressed " ) ){
+            // the window call site only starts after the threads finished
+            if( window_lines.empty() ){
+                success &= ( 1 == sscanf( line.c_str() + line.find( "suppressed " ), "suppressed %llu", &count ) );
+                rate_suppressed += count;
+            }else{
+                window_lines.push_back( line );
+            }
+        }else if( std::string::npos != line.find( "testing rate limit window:" ) ){
+            window_lines.push_back( line );
+        }else if( std::string::npos != line.find( "testing sampled logging:" ) ){
+            ++sampled;
+            sampled_skipped += count;
+        }else if( std::string::npos != line.find( "testing random sampled logging:" ) ){
+            ++random_sampled;
+            random_skipped += count;
+        }else if( std::string::npos != line.find( "testing sample skips:" ) ){
+            skip_lines.push_back( line );
+        }
+    }
+
+    // exact counts, the call sites count atomically
+    success &= ( 1 == once ) && ( 3 == limited ) && ( 1 == limit_notes );
+    success &= ( ( calls + 63 ) / 64 == sampled ) && ( sampled + sampled_skipped <= calls );
+    // the window changes at most a few times during the threaded calls
+    success &= ( 2 <= rated ) && ( rated + rate_suppressed <= calls );
+    // sampled with a probability of 1/16 (expected: 50 of 800 calls)
+    success &= ( 0 < random_sampled ) && ( random_sampled < calls / 4 ) && ( random_sampled + random_skipped <= calls );
+
+    // single-threaded: 2 messages in the first window, the suppressed 97 are reported in the next one
+    success &= ( 4 == window_lines.size() )
+            && ( std::string::npos != window_lines[0].find( "testing rate limit window: message(0)" ) )
+            && ( std::string::npos != window_lines[1].find( "testing rate limit window: message(1)" ) )
+            && ( std::string::npos != window_lines[2].find( "Rate limit(2/s) suppressed 97 messages." ) )
+            && ( std::string::npos != window_lines[3].find( "testing rate limit window: message(99)" ) );
+    success &= ( 4 == skip_lines.size() );
+    for( size_t i=0; i<skip_lines.size(); ++i ){
+        const std::string expected = "[sampled 1/64, skipped " + std::to_string( ( 0 == i ) ? 0 : 63 )
+                                     + "] testing sample skips: message(" + std::to_string( i * 64 ) + ")";
+        success &= ( std::string::npos != skip_lines[i].find( expected ) );
+    }
+
+    std::cout << "limited logging test: once(" << once << ") limited(" << limited << ") rate limited(" << rated
+              << ") sampled(" << sampled << ") random sampled(" << random_sampled << ") "
+              << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    if( !success ){
+        memory->Dump( std::cout );
+    }
+    return success;
+}
+
+
+// runs without the writer thread, every record is written synchronously
+//   checks the keys (in call order), the escaping and the formatting of the values in both formats
+bool TestLogger::
+testKeyValueLogging()
+{
+    auto memory = std::make_shared<pt::log::MemorySink>();
+    pt::log::BindSinks( pt::log::out, pt::log::SinkList{ memory } );
+    pt::log::BindSinks( pt::log::warn, pt::log::SinkList{ memory } );
+    pt::log::SetTimestamps( false );
+
+    static const pt::Name event( "cache_miss" );
+    static const pt::Name key_name( "lat_us" );
+    for( int i=0; i<2; ++i ){
+        PT_LOG_KV( out, "event", event, "key", 42 + i, key_name, 17.5, "path", "/api/\"quoted\"", "hit", false );
+    }
+    PT_LOG_KV( out, "text", "back\\slash\n\ttab\x01 \xc3\xa1rv\xc3\xadz", "neg", -7, "max", 18446744073709551615ull,
+               "third", 1.0 / 3.0, "tenth", 0.1, "big", 1e300, "nan", std::nan( "" ), "char", 'x' );
+    // the values are evaluated once, also at the first call, that registers the site
+    int evaluated = 0;
+    for( int i=0; i<2; ++i ){
+        PT_LOG_KV( out, "evaluated", ++evaluated );
+    }
+    pt::log::SetKeyValueFormat( pt::log::KeyValueFormat::Logfmt );
+    PT_LOG_KV( warn, "event", "logfmt test", "count", 3u, "third", 1.0 / 3.0, "eq", "a=b", "empty", "" );
+    pt::log::SetKeyValueFormat( pt::log::KeyValueFormat::Json );
+
+    pt::log::SetTimestamps( true );
+    pt::log::ResetSinks( pt::log::out );
+    pt::log::ResetSinks( pt::log::warn );
+
+    // JSON lines start with the time of the record
+    const std::string time_start = "{\"time\":\"";
+    const size_t      time_end   = time_start.length() + pt::log::TimestampFormatter::Length;
+    const std::vector<std::string> expected = {
+        "\",\"stream\":\"Log\",\"event\":\"cache_miss\",\"key\":42,\"lat_us\":17.5,\"path\":\"/api/\\\"quoted\\\"\",\"hit\":false}",
+        "\",\"stream\":\"Log\",\"event\":\"cache_miss\",\"key\":43,\"lat_us\":17.5,\"path\":\"/api/\\\"quoted\\\"\",\"hit\":false}",
+        "\",\"stream\":\"Log\",\"text\":\"back\\\\slash\\n\\ttab\\u0001 \xc3\xa1rv\xc3\xadz\",\"neg\":-7,\"max\":18446744073709551615,"
+            "\"third\":0.3333333333333333,\"tenth\":0.1,\"big\":1e+300,\"nan\":null,\"char\":\"x\"}",
+        "\",\"stream\":\"Log\",\"evaluated\":1}",
+        "\",\"stream\":\"Log\",\"evaluated\":2}",
+        "Warning: event=\"logfmt test\" count=3 third=0.3333333333333333 eq=\"a=b\" empty=\"\"",
+    };
+
+    std::stringstream contents( memory->GetContents() );
+    std::string line;
+    size_t index = 0;
+    bool success = true;
+    while( std::getline( contents, line ) ){
+        if( ( expected.size() <= index ) ){
+            success = false;
+            break;
+        }
+        if( 0 == line.compare( 0, time_start.length(), time_start ) ){
+            line = ( time_end <= line.length() ) ? line.substr( time_end ) : std::string();
+        }
+        success &= ( expected[index] == line );
+        ++index;
+    }
+    success &= ( expected.size() == index ) && ( 2 == evaluated );
+
+    std::cout << "key-value logging test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+    if( !success ){
+        memory->Dump( std::cout );
+    }
+    return success;
+}
+
+
 void TestLogger::
 printAsciiTable()
 {
@@ -0,0 +1,397 @@
+#include "TestName.hpp"
+
+#include "pt/name.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace pt::literals;
+
+namespace{
+
+void
+PrintResult( const char* test, bool success )
+{
+    std::cout << test << " test: " << ( success ? "SUCCESS" : "FAILURE" ) << "\n";
+}
+
+} // end of anonymous namespace
+
+
+bool TestName::
+run()
+{
+    std::cout << "--------------------------------------------------\n";
+#ifdef PT_NAME_COMPACT
+    std::cout << "  Testing Name (compact)                          \n";
+#else
+    std::cout << "  Testing Name                                    \n";
+#endif
+    std::cout << "--------------------------------------------------\n";
+
+#ifdef PT_NAME_COMPACT
+    bool success = ( 4 == sizeof(pt::Name) );
+#else
+    bool success = ( sizeof(void*) + sizeof(uint64_t) == sizeof(pt::Name) );
+#endif
+    PrintResult( "name size", success );
+
+    success &= testConstruction();
+    success &= testHashes();
+    success &= testLiterals();
+    success &= testFind();
+    success &= testEmbeddedNul();
+    success &= testArenaStorage();
+    success &= testConcurrentInterning();
+    success &= testContainers();
+    return success;
+}
+
+
+// every way of creating the same string has to result in the same name (id and stored string)
+bool TestName::
+testConstruction()
+{
+    char                    chars[] = "test_construction";
+    const char* const       cstr    = "test_construction";
+    const std::string       str     = "test_construction";
+    const std::string_view  view    = str;
+
+    const pt::Name from_cstr( cstr );
+    const pt::Name from_chars( chars );
+    const pt::Name from_string( str );
+    const pt::Name from_view    = pt::Name::Intern( view );
+    const pt::Name from_nameid  = pt::NameId( from_cstr ).GetName();
+    const pt::Name from_id      = pt::Name::FindById( from_cstr.GetId() );
+    pt::Name       assigned;
+    assigned = str;
+
+    bool success = !from_cstr.IsEmpty() && ( 0 != from_cstr.GetId() );
+    for( const pt::Name* name : std::vector<const pt::Name*>{ &from_chars, &from_string, &from_view,
+                                                              &from_nameid, &from_id, &assigned } )
+    {
+        success &= ( from_cstr == *name ) && !( from_cstr != *name )
+                && ( from_cstr.GetId() == name->GetId() )
+                && ( from_cstr.c_str() == name->c_str() );  // the string is stored once
+    }
+    success &= ( str == from_cstr.GetStdString() ) && ( view == from_cstr.GetStringView() )
+            && ( str.length() == from_cstr.length() );
+
+    // different strings
+    const pt::Name other( "test_construction2" );
+    success &= ( from_cstr != other ) && ( from_cstr.GetId() != other.GetId() );
+
+    // empty instances are not equal to anything, not even to each other
+    const pt::Name empty;
+    const pt::Name empty_string( "" );
+    const pt::NameId empty_id;
+    success &= empty.IsEmpty() && empty_string.IsEmpty() && empty_id.IsEmpty()
+            && ( 0 == empty.GetId() ) && ( 0 == empty_string.GetId() ) && ( 0 == empty.GetHash() )
+            && !( empty == empty_string ) && ( empty != from_cstr )
+            && ( 0 == empty.length() ) && ( std::string( "" ) == empty.c_str() )
+            && pt::Name::FindById( 0 ).IsEmpty() && empty_id.GetName().IsEmpty()
+            && pt::Name::Intern( std::string_view() ).IsEmpty();
+
+    // 'NameId' round-trip
+    const pt::NameId id( from_cstr );
+    success &= ( 4 == sizeof(id) ) && ( from_cstr.GetId() == id.GetId() ) && ( id == pt::NameId( str ) )
+            && ( id != pt::NameId( other ) ) && ( std::string( "test_construction" ) == id.c_str() );
+
+    PrintResult( "name construction", success );
+    return success;
+}
+
+
+// the hash of the names matches 'HashName()'
+bool TestName::
+testHashes()
+{
+    bool success = ( pt::HashName( "test_hash", 9 ) == pt::Name( "test_hash" ).GetHash() );
+
+    // every tail length of the hash
+    std::string str;
+    for( size_t i=0; i<12; ++i ){
+        str.push_back( static_cast<char>( 'a' + i ) );
+        const std::string data = "test_hash_" + str;
+        const uint32_t hash = pt::HashName( data.c_str(), data.length() );
+        success &= ( hash == pt::Name( data ).GetHash() )
+                && ( hash == pt::Name::Intern( data ).GetHash() );
+    }
+
+    PrintResult( "name hash", success );
+    return success;
+}
+
+
+// literals are hashed at compile time, 'PT_NAME()' interns once per call site,
+//   comparing with a literal doesn't intern it
+bool TestName::
+testLiterals()
+{
+    constexpr uint32_t literal_hash = "test_literal"_name.GetHash();
+    static_assert( literal_hash == pt::HashName( "test_literal", 12 ), "literal hash has to be computed at compile time" );
+
+    const pt::Name name( "test_literal" );
+    const pt::Name from_literal = "test_literal"_name;
+    const pt::Name from_macro   = PT_NAME( "test_literal" );
+    bool success = ( name == from_literal ) && ( name == from_macro ) && ( name.c_str() == from_macro.c_str() )
+                && ( literal_hash == name.GetHash() ) && ( literal_hash == from_macro.GetHash() );
+
+    // the same call site returns the same instance
+    const pt::Name* site = nullptr;
+    for( size_t i=0; i<2; ++i ){
+        const pt::Name& site_name = PT_NAME( "test_literal_site" );
+        success &= ( nullptr == site ) || ( site == &site_name );
+        site = &site_name;
+    }
+
+    // comparisons with literals, in both orders
+    success &= ( name == "test_literal"_name ) && ( "test_literal"_name == name )
+            && ( name != "test_literal2"_name ) && ( "test_literaL"_name != name )
+            && ( name != "test_"_name ) && ( pt::Name() != ""_name ) && ( pt::Name() != "test_literal"_name );
+    // ... without interning the literal
+    success &= ( name != "test_literal_not_interned"_name ) && ( "test_literal_not_interned"_name != name )
+            && pt::Name::Find( "test_literal_not_interned" ).IsEmpty();
+
+    // 'switch'-based dispatch
+    const pt::Name state( "test_literal_busy" );
+    int selected = 0;
+    switch( state.GetHash() ){
+    case "test_literal_idle"_name.GetHash():  if( state == "test_literal_idle"_name ){ selected = 1; } break;
+    case "test_literal_busy"_name.GetHash():  if( state == "test_literal_busy"_name ){ selected = 2; } break;
+    default: break;
+    }
+    success &= ( 2 == selected );
+
+    PrintResult( "name literal", success );
+    return success;
+}
+
+
+// 'Find()' doesn't intern missing strings, 'Intern()' interns string views
+bool TestName::
+testFind()
+{
+    const std::string missing = "test_find_missing";
+    bool success = pt::Name::Find( missing ).IsEmpty() && pt::Name::Find( "" ).IsEmpty();
+
+    // no id was taken by the lookups above (no other thread interns at this point)
+    const pt::Name before( "test_find_before" );
+    success &= pt::Name::Find( missing ).IsEmpty();
+    const pt::Name after( "test_find_after" );
+    success &= ( before.GetId() + 1 == after.GetId() );
+
+    // found without a null-terminated copy, once interned
+    const std::string text = "prefix test_find_missing suffix";
+    const std::string_view token = std::string_view( text ).substr( 7, missing.length() );
+    success &= pt::Name::Find( token ).IsEmpty();
+    const pt::Name interned( missing );
+    success &= ( interned == pt::Name::Find( token ) ) && ( interned == pt::Name::Find( missing ) );
+
+    // 'Intern()' of tokens (not null-terminated) stores a terminated copy of new strings only
+    const std::string tokens = "test_intern_a test_intern_b";
+    const std::string_view token_a = std::string_view( tokens ).substr( 0, 13 );
+    const std::string_view token_b = std::string_view( tokens ).substr( 14 );
+    const pt::Name intern_a = pt::Name::Intern( token_a );
+    const pt::Name intern_b = pt::Name::Intern( token_b );
+    success &= ( pt::Name( "test_intern_a" ) == intern_a ) && ( intern_a != intern_b )
+            && ( std::string( "test_intern_a" ) == intern_a.c_str() ) && ( tokens.data() != intern_a.c_str() )
+            && ( intern_a == pt::Name::Find( token_a ) ) && ( intern_b == pt::Name::Find( "test_intern_b" ) );
+    // interning an existing string takes no id
+    const pt::Name before_intern( "test_intern_before" );
+    success &= ( intern_a == pt::Name::Intern( token_a ) ) && ( intern_a.c_str() == pt::Name::Intern( token_a ).c_str() );
+    const pt::Name after_intern( "test_intern_after" );
+    success &= ( before_intern.GetId() + 1 == after_intern.GetId() );
+
+    PrintResult( "name find", success );
+    return success;
+}
+
+
+// names of strings with embedded null characters are different from their prefixes
+bool TestName::
+testEmbeddedNul()
+{
+    const std::string a_nul_b( "test_nul\0b", 10 );
+    const std::string a_nul_c( "test_nul\0c", 10 );
+
+    const pt::Name name_b( a_nul_b );
+    const pt::Name name_c( a_nul_c );
+    const pt::Name prefix( a_nul_b.c_str() );   // stops at the null character
+
+    bool success = ( 10 == name_b.length() ) && ( a_nul_b == name_b.GetStdString() )
+                && ( a_nul_b == name_b.GetStringView() ) && ( 8 == prefix.length() )
+                && ( name_b != name_c ) && ( name_b != prefix ) && ( name_c != prefix )
+                && ( name_b == pt::Name::Intern( a_nul_b ) ) && ( name_b == pt::Name::Find( a_nul_b ) )
+                && ( name_b == "test_nul\0b"_name ) && ( name_c != "test_nul\0b"_name )
+                && ( name_b == pt::NameId( name_b ).GetName() )
+                && pt::Name::Find( std::string( "test_nul\0d", 10 ) ).IsEmpty();
+
+    PrintResult( "name embedded null", success );
+    return success;
+}
+
+
+// the stored strings are packed into arenas, they never move and stay null-terminated
+//   the small strings fill several arena blocks, the large ones get their own blocks
+bool TestName::
+testArenaStorage()
+{
+    std::vector<std::string>    strings;
+    std::vector<pt::Name>       names;
+    std::vector<const char*>    stored;
+    for( size_t i=0; i<4000; ++i ){
+        strings.push_back( "test_arena_" + std::to_string( i ) + std::string( i % 500, static_cast<char>( 'a' + i % 26 ) ) );
+        if( 0 == i % 1000 ){
+            strings.push_back( "test_arena_large_" + std::to_string( i ) + std::string( 300 * 1024, 'x' ) );
+        }
+    }
+    for( const auto& str : strings ){
+        names.push_back( pt::Name( str ) );
+        stored.push_back( names.back().c_str() );
+    }
+
+    bool success = true;
+    for( size_t i=0; i<strings.size(); ++i ){
+        const pt::Name& name = names[i];
+        success &= ( stored[i] == name.c_str() ) && ( stored[i] == pt::Name( strings[i] ).c_str() )
+                && ( strings[i].length() == name.length() ) && ( '\0' == stored[i][name.length()] )
+                && ( strings[i] == name.GetStringView() );
+    }
+
+    // the 'std::string' copy is created once
+    const std::string& copy = names[1].GetStdString();
+    success &= ( &copy == &pt::Name( strings[1] ).GetStdString() ) && ( strings[1] == copy );
+
+    PrintResult( "name arena storage", success );
+    return success;
+}
+
+
+// threads interning the same strings in different orders get the same ids,
+//   while every thread also interns its own new strings (the shards of the table grow concurrently,
+//   the ids grow past a chunk of the id lookup)
+bool TestName::
+testConcurrentInterning( size_t thread_count, size_t name_count )
+{
+    std::vector<std::string> strings;
+    for( size_t i=0; i<name_count; ++i ){
+        strings.push_back( "test_concurrent_" + std::to_string( i ) );
+    }
+    // interned before the shards grow, its stored string must not move
+    const pt::Name  early( strings[0] );
+    const char*     early_chars = early.c_str();
+
+    std::vector< std::vector<uint64_t> > ids( thread_count, std::vector<uint64_t>( name_count, 0 ) );
+    std::vector< std::vector<uint64_t> > own_ids( thread_count, std::vector<uint64_t>( name_count, 0 ) );
+    std::vector<std::thread> threads;
+    for( size_t t=0; t<thread_count; ++t ){
+        threads.push_back( std::thread( [&strings, &ids, &own_ids, t, thread_count, name_count](){
+            // every thread starts at a different position
+            for( size_t j=0; j<name_count; ++j ){
+                const size_t i = ( j + t * name_count / thread_count ) % name_count;
+                ids[t][i] = pt::Name( strings[i] ).GetId();
+                own_ids[t][j] = pt::Name( "test_concurrent_own_" + std::to_string( t ) + "_" + std::to_string( j ) ).GetId();
+            }
+        } ) );
+    }
+    for( auto& thread : threads ){
+        thread.join();
+    }
+
+    bool success = ( early_chars == pt::Name( strings[0] ).c_str() ) && ( strings[0] == early_chars );
+    std::set<uint64_t> unique;
+    for( size_t i=0; i<name_count; ++i ){
+        success &= ( 0 != ids[0][i] ) && ( pt::Name( strings[i] ).GetId() == ids[0][i] )
+                && ( strings[i] == pt::Name::FindById( ids[0][i] ).GetStringView() );
+        for( size_t t=1; t<thread_count; ++t ){
+            success &= ( ids[0][i] == ids[t][i] );
+        }
+        unique.insert( ids[0][i] );
+    }
+    for( size_t t=0; t<thread_count; ++t ){
+        for( size_t j=0; j<name_count; ++j ){
+            const std::string own = "test_concurrent_own_" + std::to_string( t ) + "_" + std::to_string( j );
+            success &= ( own == pt::Name::FindById( own_ids[t][j] ).GetStringView() );
+            unique.insert( own_ids[t][j] );
+        }
+    }
+    success &= ( ( thread_count + 1 ) * name_count == unique.size() );
+
+    PrintResult( "name concurrent interning", success );
+    return success;
+}
+
+
+// names as keys of ordered and unordered containers, hashes of ids, lexical ordering
+bool TestName::
+testContainers()
+{
+    const std::vector<std::string> strings = { "test_key_c", "test_key_a", "test_key_b" };
+
+    std::map<pt::Name, int>             ordered;
+    std::unordered_map<pt::Name, int>   unordered;
+    std::unordered_map<pt::NameId, int> unordered_ids;
+    for( size_t i=0; i<strings.size(); ++i ){
+        ordered[pt::Name( strings[i] )]         = static_cast<int>( i );
+        unordered[pt::Name( strings[i] )]       = static_cast<int>( i );
+        unordered_ids[pt::NameId( strings[i] )] = static_cast<int>( i );
+    }
+
+    // looked up through other construction paths
+    bool success = ( 3 == ordered.size() ) && ( 3 == unordered.size() ) && ( 3 == unordered_ids.size() )
+                && ( 0 == ordered.at( "test_key_c"_name ) ) && ( 1 == ordered.at( pt::Name::Intern( "test_key_a" ) ) )
+                && ( 2 == unordered.at( PT_NAME( "test_key_b" ) ) ) && ( 0 == unordered.at( std::string( "test_key_c" ) ) )
+                && ( 1 == unordered_ids.at( pt::NameId( "test_key_a"_name ) ) )
+                && ( 0 == ordered.count( pt::Name( "test_key_d" ) ) ) && ( 0 == unordered.count( pt::Name( "test_key_d" ) ) );
+
+    // 'operator<' orders by id, new strings are interned in increasing order
+    std::vector<int> order;
+    for( const auto& pair : ordered ){
+        order.push_back( pair.second );
+    }
+    success &= ( std::vector<int>{ 0, 1, 2 } == order );
+    success &= ( pt::Name() < pt::Name( "test_key_a" ) ) && !( pt::Name( "test_key_a" ) < pt::Name( "test_key_a" ) );
+    std::map<pt::NameId, int> ordered_ids;
+    for( size_t i=0; i<strings.size(); ++i ){
+        ordered_ids[pt::NameId( strings[i] )] = static_cast<int>( i );
+    }
+    order.clear();
+    for( const auto& pair : ordered_ids ){
+        order.push_back( pair.second );
+    }
+    success &= ( std::vector<int>{ 0, 1, 2 } == order );
+
+    // the hashes are the hashes of the ids
+    const pt::Name key( "test_key_a" );
+    success &= ( std::hash<uint64_t>{}( key.GetId() ) == std::hash<pt::Name>{}( key ) )
+            && ( std::hash<uint32_t>{}( pt::NameId( key ).GetId() ) == std::hash<pt::NameId>{}( pt::NameId( key ) ) )
+            && ( std::hash<pt::Name>{}( key ) == std::hash<pt::Name>{}( pt::Name::Intern( "test_key_a" ) ) );
+
+    // lexical ordering, including prefixes and embedded null characters
+    std::set<pt::Name, pt::NameLexicalLess> lexical;
+    for( const auto& str : strings ){
+        lexical.insert( pt::Name( str ) );
+    }
+    lexical.insert( pt::Name( "test_key" ) );
+    lexical.insert( pt::Name( std::string( "test_key\0z", 10 ) ) );
+    lexical.insert( pt::Name( "test_key_a" ) );
+    lexical.insert( pt::Name() );
+    std::vector<std::string_view> sorted;
+    for( const auto& name : lexical ){
+        sorted.push_back( name.GetStringView() );
+    }
+    const std::vector<std::string_view> expected = { "", "test_key", std::string_view( "test_key\0z", 10 ),
+                                                     "test_key_a", "test_key_b", "test_key_c" };
+    success &= ( expected == sorted );
+
+    PrintResult( "name containers", success );
+    return success;
+}
@@ -0,0 +1,220 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    bench_log.cpp
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Throughput and latency benchmark of the logger ('pt::log::out').
+  *          Runs every combination of sink configuration, producer thread count and message size.
+  *            Every run initializes the logger, logs from the producer threads,
+  *            then 'pt::log::Destroy()' drains the queue (included in the total time).
+  *          Prints one JSON object per run (JSON lines) to stdout, eg.:
+  *            {"bench":"log","sink":"null","threads":4,"message_size":128,"messages":400000,
+  *             "producer_seconds":0.08,"total_seconds":0.11,"messages_per_second":3636363,
+  *             "latency_ns":{"p50":95,"p90":160,"p99":820,"p999":4100,"max":51000}}
+  *          Latency is measured around every single logging call (producer side).
+  * USAGE:   ptlib_bench_log [threads=<N>] [messages=<N>] [sizes=<N,...>] [sinks=<name,...>] [dir=<path>]
+  *            threads:  maximum producer count, runs 1, 2, 4, ... below N, then N (default: hardware concurrency)
+  *            messages: per producer thread (default: 100000)
+  *            sizes:    message sizes in bytes (default: 16,128,1024)
+  *            sinks:    null, memory, file, mapped, console (default: null,memory,file)
+  *                        "mapped" is the "file" sink with 'pt::log::FileMode::Mapped'
+  *            dir:      directory of the log files (default: ./)
+  * -----------------------------------------------------------------------------
+  */
+
+#include "pt/logging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchSettings{
+    size_t                      maxThreads  = std::max( 1u, std::thread::hardware_concurrency() );
+    size_t                      messages    = 100000;
+    std::vector<size_t>         sizes       = { 16, 128, 1024 };
+    std::vector<std::string>    sinks       = { "null", "memory", "file" };
+    std::string                 directory   = "./";
+};
+
+struct BenchResult{
+    double                  producerSeconds = 0.0;
+    double                  totalSeconds    = 0.0;
+    std::vector<uint32_t>   latencies;      // in nanoseconds, every call of every thread
+};
+
+
+static std::vector<std::string>
+SplitList( const std::string& list )
+{
+    std::vector<std::string> items;
+    std::stringstream ss( list );
+    std::string item;
+    while( std::getline( ss, item, ',' ) ){
+        if( 0 < item.length() ){
+            items.push_back( item );
+        }
+    }
+    return items;
+}
+
+
+static bool
+ParseArguments( int argc, char** argv, BenchSettings& settings )
+{
+    for( int i=1; i<argc; ++i ){
+        const std::string arg = argv[i];
+        const size_t separator = arg.find( '=' );
+        if( std::string::npos == separator ){
+            return false;
+        }
+        const std::string key   = arg.substr( 0, separator );
+        const std::string value = arg.substr( separator+1 );
+        if( "threads" == key ){
+            settings.maxThreads = std::max<size_t>( 1, std::strtoull( value.c_str(), nullptr, 10 ) );
+        }else if( "messages" == key ){
+            settings.messages = std::max<size_t>( 1, std::strtoull( value.c_str(), nullptr, 10 ) );
+        }else if( "sizes" == key ){
+            settings.sizes.clear();
+            for( const auto& size : SplitList( value ) ){
+                settings.sizes.push_back( std::strtoull( size.c_str(), nullptr, 10 ) );
+            }
+        }else if( "sinks" == key ){
+            settings.sinks = SplitList( value );
+        }else if( "dir" == key ){
+            settings.directory = value;
+        }else{
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// doubles the thread count, the last step is 'max_threads' itself (also when it isn't a power of 2)
+static size_t
+NextThreadCount( size_t thread_count, size_t max_threads )
+{
+    return ( thread_count < max_threads ) ? std::min( thread_count * 2, max_threads ) : max_threads + 1;
+}
+
+
+static uint32_t
+Percentile( const std::vector<uint32_t>& sorted, double fraction )
+{
+    if( sorted.empty() ){
+        return 0;
+    }
+    size_t index = static_cast<size_t>( fraction * ( sorted.size() - 1 ) );
+    return sorted[index];
+}
+
+
+static bool
+RunBench( const BenchSettings& settings, const std::string& sink,
+          size_t thread_count, size_t message_size, BenchResult& result )
+{
+    const bool mapped = ( "mapped" == sink );
+    pt::log::SetFileMode( mapped ? pt::log::FileMode::Mapped : pt::log::FileMode::Buffered );
+    if( !pt::log::Initialize( settings.directory, "bench_log.txt" ) ){
+        return false;
+    }
+    if( !pt::log::BindSinks( pt::log::out, { mapped ? "file" : sink } ) ){
+        pt::log::Destroy();
+        return false;
+    }
+
+    const std::string payload( message_size, 'x' );
+    std::vector< std::vector<uint32_t> > latencies( thread_count );
+    std::vector<std::thread> threads;
+
+    const auto start = Clock::now();
+    for( size_t t=0; t<thread_count; ++t ){
+        threads.push_back( std::thread( [&settings, &payload, &latencies, t](){
+            std::vector<uint32_t>& samples = latencies[t];
+            samples.reserve( settings.messages );
+            for( size_t i=0; i<settings.messages; ++i ){
+                const auto call_start = Clock::now();
+                PT_LOG_INFO( payload );
+                const auto call_end = Clock::now();
+                samples.push_back( static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>( call_end - call_start ).count() ) );
+            }
+        } ) );
+    }
+    for( auto& thread : threads ){
+        thread.join();
+    }
+    const auto produced = Clock::now();
+    pt::log::Destroy();
+    const auto drained = Clock::now();
+
+    pt::log::ResetSinks( pt::log::out );
+
+    result.producerSeconds = std::chrono::duration<double>( produced - start ).count();
+    result.totalSeconds    = std::chrono::duration<double>( drained - start ).count();
+    result.latencies.clear();
+    for( const auto& samples : latencies ){
+        result.latencies.insert( result.latencies.end(), samples.begin(), samples.end() );
+    }
+    std::sort( result.latencies.begin(), result.latencies.end() );
+    return true;
+}
+
+
+static void
+PrintResult( const std::string& sink, size_t thread_count, size_t message_size,
+             size_t message_count, const BenchResult& result )
+{
+    const auto& lat = result.latencies;
+    char line[512];
+    snprintf( line, sizeof(line),
+              "{\"bench\":\"log\",\"sink\":\"%s\",\"threads\":%zu,\"message_size\":%zu,\"messages\":%zu,"
+              "\"producer_seconds\":%.6f,\"total_seconds\":%.6f,\"messages_per_second\":%.0f,"
+              "\"latency_ns\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"p999\":%u,\"max\":%u}}\n",
+              sink.c_str(), thread_count, message_size, message_count,
+              result.producerSeconds, result.totalSeconds,
+              ( 0.0 < result.totalSeconds ) ? message_count / result.totalSeconds : 0.0,
+              Percentile( lat, 0.50 ), Percentile( lat, 0.90 ), Percentile( lat, 0.99 ),
+              Percentile( lat, 0.999 ), lat.empty() ? 0u : lat.back() );
+    // bypasses the "console" sink's stream, so the results stay on separate lines
+    fputs( line, stdout );
+    fflush( stdout );
+}
+
+
+int
+main( int argc, char** argv )
+{
+    BenchSettings settings;
+    if( !ParseArguments( argc, argv, settings ) ){
+        std::cerr << "usage: " << argv[0]
+                  << " [threads=<N>] [messages=<N>] [sizes=<N,...>] [sinks=<name,...>] [dir=<path>]\n";
+        return 1;
+    }
+
+    pt::log::RegisterSink( "memory", std::make_shared<pt::log::MemorySink>() );
+
+    for( const auto& sink : settings.sinks ){
+        for( size_t threads=1; threads<=settings.maxThreads; threads=NextThreadCount( threads, settings.maxThreads ) ){
+            for( size_t size : settings.sizes ){
+                BenchResult result;
+                if( !RunBench( settings, sink, threads, size, result ) ){
+                    std::cerr << "failed to run benchmark with sink '" << sink << "'\n";
+                    return 1;
+                }
+                PrintResult( sink, threads, size, threads * settings.messages, result );
+            }
+        }
+    }
+
+    // the benchmark logs are not needed
+    std::remove( ( settings.directory + "bench_log.txt" ).c_str() );
+    return 0;
+}
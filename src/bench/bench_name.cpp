@@ -0,0 +1,176 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    bench_name.cpp
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Multi-threaded interning benchmark of 'pt::Name'.
+  *          Every thread constructs 'pt::Name'-s from prepared strings (interning them).
+  *            intern: every thread interns its own, new strings (inserts into the table)
+  *            lookup: every thread interns the same, already interned strings (finds existing names)
+  *          Runs 1, 2, 4, ... threads (the last run uses the maximum), prints one JSON object per run (JSON lines) to stdout, eg.:
+  *            {"bench":"name","mode":"lookup","threads":4,"names":400000,"seconds":0.05,
+  *             "names_per_second":8000000,"speedup":3.41}
+  *          'speedup' is the throughput compared to the single-threaded run of the mode.
+  * USAGE:   ptlib_bench_name [threads=<N>] [names=<N>] [modes=<name,...>]
+  *            threads: maximum thread count, runs 1, 2, 4, ... below N, then N (default: hardware concurrency)
+  *            names:   per thread (default: 100000)
+  *            modes:   intern, lookup (default: intern,lookup)
+  * -----------------------------------------------------------------------------
+  */
+
+#include "pt/name.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchSettings{
+    size_t                      maxThreads  = std::max( 1u, std::thread::hardware_concurrency() );
+    size_t                      names       = 100000;
+    std::vector<std::string>    modes       = { "intern", "lookup" };
+};
+
+
+static std::vector<std::string>
+SplitList( const std::string& list )
+{
+    std::vector<std::string> items;
+    std::stringstream ss( list );
+    std::string item;
+    while( std::getline( ss, item, ',' ) ){
+        if( 0 < item.length() ){
+            items.push_back( item );
+        }
+    }
+    return items;
+}
+
+
+static bool
+ParseArguments( int argc, char** argv, BenchSettings& settings )
+{
+    for( int i=1; i<argc; ++i ){
+        const std::string arg = argv[i];
+        const size_t separator = arg.find( '=' );
+        if( std::string::npos == separator ){
+            return false;
+        }
+        const std::string key   = arg.substr( 0, separator );
+        const std::string value = arg.substr( separator+1 );
+        if( "threads" == key ){
+            settings.maxThreads = std::max<size_t>( 1, std::strtoull( value.c_str(), nullptr, 10 ) );
+        }else if( "names" == key ){
+            settings.names = std::max<size_t>( 1, std::strtoull( value.c_str(), nullptr, 10 ) );
+        }else if( "modes" == key ){
+            settings.modes = SplitList( value );
+        }else{
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// asset-like names, eg.: "run3/textures/t1/asset_1234"
+static std::vector<std::string>
+MakeStrings( const std::string& prefix, size_t count )
+{
+    std::vector<std::string> strings;
+    strings.reserve( count );
+    for( size_t i=0; i<count; ++i ){
+        strings.push_back( prefix + "/asset_" + std::to_string( i ) );
+    }
+    return strings;
+}
+
+
+// doubles the thread count, the last step is 'max_threads' itself (also when it isn't a power of 2)
+static size_t
+NextThreadCount( size_t thread_count, size_t max_threads )
+{
+    return ( thread_count < max_threads ) ? std::min( thread_count * 2, max_threads ) : max_threads + 1;
+}
+
+
+// returns the elapsed seconds of the threads
+static double
+RunBench( const std::vector< std::vector<std::string> >& inputs )
+{
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for( const auto& strings : inputs ){
+        threads.push_back( std::thread( [&strings](){
+            for( const auto& str : strings ){
+                pt::Name name( str );
+            }
+        } ) );
+    }
+    for( auto& thread : threads ){
+        thread.join();
+    }
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+
+int
+main( int argc, char** argv )
+{
+    BenchSettings settings;
+    if( !ParseArguments( argc, argv, settings ) ){
+        std::cerr << "usage: " << argv[0] << " [threads=<N>] [names=<N>] [modes=<name,...>]\n";
+        return 1;
+    }
+
+    size_t run = 0;
+    for( const auto& mode : settings.modes ){
+        const bool intern = ( "intern" == mode );
+        if( !intern && ( "lookup" != mode ) ){
+            std::cerr << "unknown mode '" << mode << "'\n";
+            return 1;
+        }
+
+        // names of the 'lookup' mode are interned before the measured runs
+        //   every thread starts at a different position of the same list
+        const std::vector<std::string> shared = MakeStrings( "shared/textures", settings.names );
+        if( !intern ){
+            RunBench( { shared } );
+        }
+
+        double single_thread_rate = 0.0;
+        for( size_t thread_count=1; thread_count<=settings.maxThreads;
+             thread_count=NextThreadCount( thread_count, settings.maxThreads ) )
+        {
+            std::vector< std::vector<std::string> > inputs;
+            for( size_t t=0; t<thread_count; ++t ){
+                if( intern ){
+                    inputs.push_back( MakeStrings( "run" + std::to_string( run ) + "/t" + std::to_string( t ), settings.names ) );
+                }else{
+                    std::vector<std::string> rotated( shared );
+                    std::rotate( rotated.begin(), rotated.begin() + ( t * settings.names / thread_count ), rotated.end() );
+                    inputs.push_back( std::move( rotated ) );
+                }
+            }
+            ++run;
+
+            const double seconds = RunBench( inputs );
+            const size_t count   = thread_count * settings.names;
+            const double rate    = ( 0.0 < seconds ) ? count / seconds : 0.0;
+            if( 1 == thread_count ){
+                single_thread_rate = rate;
+            }
+            printf( "{\"bench\":\"name\",\"mode\":\"%s\",\"threads\":%zu,\"names\":%zu,\"seconds\":%.6f,"
+                    "\"names_per_second\":%.0f,\"speedup\":%.2f}\n",
+                    mode.c_str(), thread_count, count, seconds, rate,
+                    ( 0.0 < single_thread_rate ) ? rate / single_thread_rate : 0.0 );
+            fflush( stdout );
+        }
+    }
+    return 0;
+}
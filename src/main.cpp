@@ -2,6 +2,7 @@
 #include "TestLogger.hpp"
 #include "TestConfig.hpp"
 #include "TestEvent.hpp"
+#include "TestName.hpp"
 #include "TestUtility.hpp"
 
 #include <iostream>
@@ -58,5 +59,17 @@ int main()
         }
     }
 
+
+    {
+        TestName tn;
+        bool success = tn.run();
+
+        if(success){
+            std::cout << "Name test: SUCCESS\n\n\n\n";
+        }else{
+            std::cout << "Name test: FAILED\n\n\n\n";
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,18 @@
+#include "TestName.hpp"
+
+#include <iostream>
+
+// runs the 'pt::Name' tests with 'PT_NAME_COMPACT' defined
+//   built from the sources of 'pt::Name', the library itself is built without the macro
+int main()
+{
+    TestName tn;
+    bool success = tn.run();
+
+    if(success){
+        std::cout << "Name test (compact): SUCCESS\n\n\n\n";
+    }else{
+        std::cout << "Name test (compact): FAILED\n\n\n\n";
+    }
+    return success ? 0 : 1;
+}
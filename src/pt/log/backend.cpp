@@ -0,0 +1,524 @@
+#include "pt/log/backend.h"
+
+#include "pt/def.h"
+#include "pt/alias.h"
+#include "pt/logging.h"
+#include "pt/log/binrecord.h"
+#include "pt/log/kvrecord.h"
+#include "pt/log/logstream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+using namespace pt::log;
+
+// the writer gives control back to the wake-up check after this many records
+static const size_t gMaxBatchSize = 256;
+// upper limit of sleeping, in case a wake-up signal got lost (also the resolution of timed flushes)
+static const std::chrono::milliseconds gMaxWriterSleep( 50 );
+
+
+static bool
+IsLineCompleted( const LogRecord& record )
+{
+    return ( 0 < record.text.length() ) && ( '\n' == record.text.back() );
+}
+
+
+std::atomic<bool> pt::log::Backend::smSettingsReloadRequested( false );
+
+
+pt::log::Backend::
+Backend():
+    mLogFileSink( std::make_shared<LogFileSink>() ),
+    mSinkGeneration( 0 ),
+    mRunning( false ), mStopRequested( false ),
+    mWriterSleeping( false ), mActiveProducers( 0 ), mDropRequests( 0 )
+{
+    auto console = std::make_shared<ConsoleSink>();
+    mSinkRegistry["console"] = console;
+    mSinkRegistry["file"]    = mLogFileSink;
+    mSinkRegistry["null"]    = std::make_shared<NullSink>();
+    mDefaultSinks = std::make_shared<const SinkList>( SinkList{ console, mLogFileSink } );
+}
+
+
+pt::log::Backend::
+~Backend()
+{
+    Stop();
+}
+
+
+bool pt::log::Backend::
+Start( const std::string& file_path, const BackendSettings& settings )
+{
+    pt::MutexLockGuard lock( mDirectMutex );
+    if( mRunning ){
+        return true;
+    }
+
+    mSettings = settings;
+    if( !mLogFileSink->Open( file_path, mSettings.fileBufferSize,
+                             mSettings.daemonName, mSettings.daemonTimeoutMs,
+                             mSettings.rotation, mSettings.fileMode ) )
+    {
+        return false;
+    }
+
+    mQueue = std::unique_ptr< RingBuffer<LogRecord> >( new RingBuffer<LogRecord>( mSettings.queueCapacity ) );
+    mStopRequested = false;
+    mWriterSleeping = false;
+    mDropRequests = 0;
+    mWriter = std::thread( &Backend::WriterLoop_, this );
+    mRunning = true;
+    return true;
+}
+
+
+void pt::log::Backend::
+Stop()
+{
+    // direct writes wait, until the writer thread is gone
+    pt::MutexLockGuard lock( mDirectMutex );
+    if( !mRunning ){
+        return;
+    }
+
+    // new producers fall back to direct writes from here on
+    //   wait for the ones, that already passed the check
+    mRunning = false;
+    while( 0 < mActiveProducers ){
+        std::this_thread::yield();
+    }
+
+    mStopRequested = true;
+    WakeWriter_();
+    if( mWriter.joinable() ){
+        mWriter.join();
+    }
+
+    mLogFileSink->Close();
+}
+
+
+bool pt::log::Backend::
+IsRunning() const
+{
+    return mRunning;
+}
+
+
+bool pt::log::Backend::
+IsConnectedToDaemon() const
+{
+    return mLogFileSink->IsConnectedToDaemon();
+}
+
+
+void pt::log::Backend::
+Submit( LogRecord&& record )
+{
+    for(;;){
+        ++mActiveProducers;
+        if( mRunning ){
+            break;
+        }
+        --mActiveProducers;
+
+        // 'mRunning' only changes under 'mDirectMutex'
+        pt::MutexLockGuard lock( mDirectMutex );
+        if( !mRunning ){
+            WriteRecordDirect_( record );
+            return;
+        }
+    }
+
+    const logstream&     stream    = *record.stream;
+    const OverflowPolicy policy    = stream.getOverflowPolicy();
+    const bool           droppable = IsDroppable_( stream );
+
+    // keeps the second half of the queue for the more severe streams
+    if( (OverflowPolicy::DropBelowSeverity == policy) && droppable
+        && (mQueue->Capacity() / 2 <= mQueue->SizeApprox()) )
+    {
+        --mActiveProducers;
+        CountDrop_( stream );
+        return;
+    }
+
+    bool drop_requested = false;
+    while( !mQueue->TryPush( std::move( record ) ) ){
+        if( droppable && (OverflowPolicy::DropOldest != policy) ){
+            --mActiveProducers;
+            CountDrop_( stream );
+            return;
+        }
+
+        // the writer drops the oldest queued droppable record instead of writing it
+        //   records are only removed in queue order, the other records keep their order
+        if( droppable && !drop_requested ){
+            ++mDropRequests;
+            drop_requested = true;
+        }
+
+        // queue is full, let the writer catch up
+        WakeWriter_();
+        std::this_thread::yield();
+    }
+    --mActiveProducers;
+
+    // the writer made room otherwise, the request is not needed anymore
+    if( drop_requested ){
+        TakeDropRequest_();
+    }
+
+    if( mWriterSleeping.load() ){
+        WakeWriter_();
+    }
+}
+
+
+bool pt::log::Backend::
+RegisterSink( const std::string& name, std::shared_ptr<Sink> sink )
+{
+    if( nullptr == sink ){
+        return false;
+    }
+    pt::MutexLockGuard lock( mSinkMutex );
+    return mSinkRegistry.insert( std::make_pair( name, std::move( sink ) ) ).second;
+}
+
+
+std::shared_ptr<Sink> pt::log::Backend::
+FindSink( const std::string& name ) const
+{
+    pt::MutexLockGuard lock( mSinkMutex );
+    auto it = mSinkRegistry.find( name );
+    if( mSinkRegistry.end() == it ){
+        return nullptr;
+    }
+    return it->second;
+}
+
+
+void pt::log::Backend::
+BindSinks( const logstream& stream, const SinkList& sinks )
+{
+    SinkList valid_sinks;
+    for( const auto& sink : sinks ){
+        if( nullptr != sink ){
+            valid_sinks.push_back( sink );
+        }
+    }
+
+    pt::MutexLockGuard lock( mSinkMutex );
+    mSinkBindings[&stream] = std::make_shared<const SinkList>( std::move( valid_sinks ) );
+    ++mSinkGeneration;
+}
+
+
+void pt::log::Backend::
+ResetSinks( const logstream& stream )
+{
+    pt::MutexLockGuard lock( mSinkMutex );
+    mSinkBindings.erase( &stream );
+    ++mSinkGeneration;
+}
+
+
+void pt::log::Backend::
+EmergencyFlush( const char* header, size_t header_length )
+{
+    // the buffered data is older than the queued records
+    mLogFileSink->EmergencyFlush();
+    mLogFileSink->EmergencyWrite( header, header_length );
+    if( !mRunning || !mQueue ){
+        return;
+    }
+
+    // popped records are never destroyed: no 'free()' in signal handlers
+    alignas(LogRecord) static char record_storage[sizeof(LogRecord)];
+    char line[4096];
+    for(;;){
+        LogRecord* record = new( record_storage ) LogRecord();
+        if( !mQueue->TryPop( *record ) ){
+            return;
+        }
+
+        // no timestamps, formatting the local time is not async-signal-safe
+        size_t length = 0;
+        if( (nullptr != record->stream) && (RecordType::Json != record->type) ){
+            const std::string& prefix = record->stream->getPrefix();
+            if( (0 < prefix.length()) && (prefix.length() + 2 < sizeof(line)) ){
+                memcpy( line, prefix.data(), prefix.length() );
+                memcpy( line + prefix.length(), ": ", 2 );
+                length = prefix.length() + 2;
+            }
+        }
+
+        // formatting needs allocations and the format site registry
+        const bool   is_text = ( RecordType::Text == record->type ) || ( RecordType::Json == record->type );
+        const char*  text    = is_text ? record->text.data()   : "<undecoded binary record>\n";
+        const size_t text_length = is_text ? record->text.length() : strlen( text );
+        if( length + text_length <= sizeof(line) ){
+            memcpy( line + length, text, text_length );
+            mLogFileSink->EmergencyWrite( line, length + text_length );
+        }else{
+            mLogFileSink->EmergencyWrite( line, length );
+            mLogFileSink->EmergencyWrite( text, text_length );
+        }
+    }
+}
+
+
+void pt::log::Backend::
+RequestSettingsReload()
+{
+    smSettingsReloadRequested.store( true, std::memory_order_relaxed );
+}
+
+
+int pt::log::Backend::
+GetEmergencyDescriptor()
+{
+    return mLogFileSink->GetEmergencyDescriptor();
+}
+
+
+bool pt::log::Backend::
+IsDroppable_( const logstream& stream ) const
+{
+    switch( stream.getOverflowPolicy() ){
+    case OverflowPolicy::Block:
+        return false;
+    case OverflowPolicy::DropBelowSeverity:
+        return stream.getSeverity() < mSettings.overflowSeverity;
+    default:
+        return true;
+    }
+}
+
+
+bool pt::log::Backend::
+TakeDropRequest_()
+{
+    uint32_t requests = mDropRequests.load();
+    while( 0 < requests ){
+        if( mDropRequests.compare_exchange_weak( requests, requests - 1 ) ){
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void pt::log::Backend::
+CountDrop_( const logstream& stream )
+{
+    if( stream.countDrop() ){
+        pt::MutexLockGuard lock( mDropMutex );
+        mDropReports.push_back( &stream );
+    }
+}
+
+
+void pt::log::Backend::
+ReportDrops_()
+{
+    std::vector<const logstream*> streams;
+    {
+        pt::MutexLockGuard lock( mDropMutex );
+        streams.swap( mDropReports );
+    }
+
+    for( const logstream* stream : streams ){
+        const uint64_t count = stream->takeDropsSinceReport();
+        if( 0 == count ){
+            continue;
+        }
+        std::string text = "WARNING: Logging queue overflow: dropped " + std::to_string( count )
+                         + " record(s) of stream '" + stream->getPrefix() + "'\n";
+        // written directly, the queue may still be full
+        LogRecord report( &pt::log::warn, std::move( text ) );
+        for( const auto& sink : GetWriterSinks_( report.stream ) ){
+            sink->Write( report );
+            MarkDirty_( sink );
+        }
+    }
+}
+
+
+void pt::log::Backend::
+WriterLoop_()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto  flush_interval = std::chrono::milliseconds( mSettings.flushIntervalMs );
+    const auto  drop_report_interval = std::chrono::milliseconds( mSettings.dropReportIntervalMs );
+    auto        last_flush = Clock::now();
+    auto        last_drop_report = last_flush;
+    LogRecord   record;
+
+    for(;;){
+        if( smSettingsReloadRequested.exchange( false, std::memory_order_relaxed ) ){
+            pt::log::LoadSettings();
+        }
+        RefreshWriterBindings_();
+
+        size_t count = 0;
+        bool   line_completed = false;
+        while( (count < gMaxBatchSize) && mQueue->TryPop( record ) ){
+            ++count;
+            if( (nullptr != record.stream) && IsDroppable_( *record.stream ) && TakeDropRequest_() ){
+                CountDrop_( *record.stream );
+                continue;
+            }
+            DecodeRecord_( record, mDecodeScratch );
+            for( const auto& sink : GetWriterSinks_( record.stream ) ){
+                sink->Write( record );
+                MarkDirty_( sink );
+            }
+            line_completed |= IsLineCompleted( record );
+        }
+
+        if( mSettings.flushOnSend && line_completed ){
+            FlushDirtySinks_();
+            last_flush = Clock::now();
+        }
+
+        auto now = Clock::now();
+        if( (0 < mSettings.dropReportIntervalMs) && (drop_report_interval <= now - last_drop_report) ){
+            ReportDrops_();
+            last_drop_report = now;
+        }
+        if( (0 < mSettings.flushIntervalMs) && (flush_interval <= now - last_flush) ){
+            FlushDirtySinks_();
+            last_flush = now;
+        }
+
+        if( 0 < count ){
+            continue;
+        }
+
+        // queue is empty here
+        if( mStopRequested ){
+            break;
+        }
+
+        pt::MutexLock lock( mWakeMutex );
+        mWriterSleeping = true;
+        if( mQueue->IsEmptyApprox() && !mStopRequested ){
+            mWakeCondition.wait_for( lock, gMaxWriterSleep );
+        }
+        mWriterSleeping = false;
+    }
+
+    ReportDrops_();
+    FlushDirtySinks_();
+    mWriterBindings.clear();
+}
+
+
+void pt::log::Backend::
+WakeWriter_()
+{
+    pt::MutexLockGuard lock( mWakeMutex );
+    mWakeCondition.notify_one();
+}
+
+
+void pt::log::Backend::
+WriteRecordDirect_( LogRecord& record )
+{
+    std::string scratch;
+    DecodeRecord_( record, scratch );
+
+    std::shared_ptr<const SinkList> sinks = mDefaultSinks;
+    {
+        pt::MutexLockGuard lock( mSinkMutex );
+        auto it = mSinkBindings.find( record.stream );
+        if( mSinkBindings.end() != it ){
+            sinks = it->second;
+        }
+    }
+    for( const auto& sink : *sinks ){
+        sink->Write( record );
+        sink->Flush();
+    }
+}
+
+
+void pt::log::Backend::
+DecodeRecord_( LogRecord& record, std::string& scratch )
+{
+    // the decoded text takes the place of the payload, 'scratch' keeps the payload's capacity for reuse
+    if( RecordType::Binary == record.type ){
+        scratch.clear();
+        FormatBinaryRecord( record.text, scratch );
+        record.text.swap( scratch );
+        record.type = RecordType::Text;
+    }else if( RecordType::KeyValue == record.type ){
+        scratch.clear();
+        const KeyValueFormat format = FormatKeyValueRecord( record.text, record.timestamp,
+                                                            record.stream->getPrefix(), scratch );
+        record.text.swap( scratch );
+        record.type = ( KeyValueFormat::Json == format ) ? RecordType::Json : RecordType::Text;
+    }
+}
+
+
+void pt::log::Backend::
+RefreshWriterBindings_()
+{
+    const uint64_t generation = mSinkGeneration.load();
+    if( generation == mWriterGeneration ){
+        return;
+    }
+    pt::MutexLockGuard lock( mSinkMutex );
+    mWriterBindings   = mSinkBindings;
+    mWriterGeneration = mSinkGeneration.load();
+}
+
+
+const SinkList& pt::log::Backend::
+GetWriterSinks_( const logstream* stream ) const
+{
+    auto it = mWriterBindings.find( stream );
+    if( mWriterBindings.end() == it ){
+        return *mDefaultSinks;
+    }
+    return *it->second;
+}
+
+
+void pt::log::Backend::
+MarkDirty_( const std::shared_ptr<Sink>& sink )
+{
+    // only a handful of sinks are in use, a linear search is the cheapest
+    if( mDirtySinks.end() == std::find( mDirtySinks.begin(), mDirtySinks.end(), sink ) ){
+        mDirtySinks.push_back( sink );
+    }
+}
+
+
+void pt::log::Backend::
+FlushDirtySinks_()
+{
+    for( const auto& sink : mDirtySinks ){
+        sink->Flush();
+    }
+    mDirtySinks.clear();
+}
+
+
+Backend& pt::log::
+GetBackend()
+{
+    // constructed at first use (during 'Initialize()' at the latest),
+    //   therefore it is destroyed before the global logstreams
+    static Backend backend;
+    return backend;
+}
@@ -0,0 +1,185 @@
+#include "pt/log/binrecord.h"
+
+#include "pt/alias.h"
+#include "pt/name.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+
+using namespace pt::log;
+using namespace pt::log::binary;
+
+// deque: registered entries never move
+static std::mutex               gFormatSiteMutex;
+static std::deque< FormatSite > gFormatSites;
+
+
+uint32_t pt::log::
+RegisterFormatSite( const char* format, const char* file, int line )
+{
+    FormatSite site;
+    site.format = ( nullptr != format ) ? format : "";
+    site.file   = ( nullptr != file )   ? file   : "";
+    site.line   = line;
+
+    pt::MutexLockGuard lock( gFormatSiteMutex );
+    gFormatSites.push_back( site );
+    return static_cast<uint32_t>( gFormatSites.size() - 1 );
+}
+
+
+bool pt::log::
+GetFormatSite( uint32_t site_id, FormatSite& site )
+{
+    pt::MutexLockGuard lock( gFormatSiteMutex );
+    if( gFormatSites.size() <= site_id ){
+        return false;
+    }
+    site = gFormatSites[site_id];
+    return true;
+}
+
+
+void pt::log::binary::
+EncodeArg( std::string& buffer, const pt::Name& value )
+{
+    Put( buffer, ArgType::Name, value.GetId() );
+}
+
+
+namespace{
+
+template<typename T>
+void
+AppendFormatted( std::string& out, const char* format, T value )
+{
+    char buffer[64];
+    int  length = snprintf( buffer, sizeof(buffer), format, value );
+    if( 0 < length ){
+        out.append( buffer, std::min<size_t>( length, sizeof(buffer)-1 ) );
+    }
+}
+
+
+bool
+AppendNextArg( PayloadReader& reader, std::string& out, ArgValue& scratch )
+{
+    if( !ReadArg( reader, scratch ) ){
+        return false;
+    }
+    AppendArgText( scratch, out );
+    return true;
+}
+
+} //end of anonymous namespace
+
+
+bool pt::log::binary::
+ReadArg( PayloadReader& reader, ArgValue& value )
+{
+    uint8_t tag;
+    if( !reader.Read( tag ) ){
+        return false;
+    }
+
+    value.type = static_cast<ArgType>( tag );
+    switch( value.type ){
+    case ArgType::Bool:{
+        uint8_t val;
+        if( !reader.Read( val ) ){ return false; }
+        value.boolValue = ( 0 != val );
+        return true;
+    }
+    case ArgType::Char:
+        return reader.Read( value.charValue );
+    case ArgType::Int:
+        return reader.Read( value.intValue );
+    case ArgType::UInt:
+        return reader.Read( value.uintValue );
+    case ArgType::Float:
+        return reader.Read( value.floatValue );
+    case ArgType::String:{
+        uint32_t length;
+        if( !reader.Read( length ) ){ return false; }
+        value.text.clear();
+        return reader.ReadBytes( value.text, length );
+    }
+    case ArgType::Name:{
+        uint64_t id;
+        if( !reader.Read( id ) ){ return false; }
+        const std::string_view text = pt::Name::FindById( id ).GetStringView();
+        value.text.assign( text.data(), text.length() );
+        return true;
+    }
+    case ArgType::Pointer:
+        return reader.Read( value.pointerValue );
+    }
+    return false;
+}
+
+
+void pt::log::binary::
+AppendArgText( const ArgValue& value, std::string& out )
+{
+    switch( value.type ){
+    case ArgType::Bool:
+        out.push_back( value.boolValue ? '1' : '0' );   // same as 'operator<<' without 'std::boolalpha'
+        break;
+    case ArgType::Char:
+        out.push_back( value.charValue );
+        break;
+    case ArgType::Int:
+        AppendFormatted( out, "%" PRId64, value.intValue );
+        break;
+    case ArgType::UInt:
+        AppendFormatted( out, "%" PRIu64, value.uintValue );
+        break;
+    case ArgType::Float:
+        AppendFormatted( out, "%g", value.floatValue );  // same as the default 'operator<<' formatting
+        break;
+    case ArgType::String:
+    case ArgType::Name:
+        out.append( value.text );
+        break;
+    case ArgType::Pointer:
+        AppendFormatted( out, "%p", reinterpret_cast<void*>( value.pointerValue ) );
+        break;
+    }
+}
+
+
+void pt::log::
+FormatBinaryRecord( const std::string& payload, std::string& out )
+{
+    PayloadReader reader( payload );
+    ArgValue      scratch;
+    uint32_t      site_id;
+    FormatSite    site;
+    if( !reader.Read( site_id ) || !GetFormatSite( site_id, site ) ){
+        out.append( "<malformed binary log record>\n" );
+        return;
+    }
+
+    bool valid = true;
+    const char* fmt = site.format;
+    while( '\0' != *fmt ){
+        if( ('{' == fmt[0]) && ('}' == fmt[1]) && valid && !reader.IsEmpty() ){
+            valid = AppendNextArg( reader, out, scratch );
+            fmt += 2;
+        }else{
+            out.push_back( *fmt );
+            ++fmt;
+        }
+    }
+    while( valid && !reader.IsEmpty() ){
+        out.push_back( ' ' );
+        valid = AppendNextArg( reader, out, scratch );
+    }
+    if( !valid ){
+        out.append( " <malformed binary log record>" );
+    }
+    out.push_back( '\n' );
+}
@@ -0,0 +1,105 @@
+#include "pt/log/category.h"
+
+#include "pt/alias.h"
+
+#include <iostream>
+#include <map>
+#include <mutex>
+
+using namespace pt::log;
+
+
+namespace{
+
+struct CategoryRegistry{
+    std::mutex                      mutex;
+    std::map< uint64_t, uint64_t >  bitsById;       // name id -> bit
+    std::vector<pt::Name>           names;          // in order of registration
+};
+
+
+CategoryRegistry&
+GetRegistry()
+{
+    static CategoryRegistry registry;
+    return registry;
+}
+
+
+uint64_t
+RegisterCategory( const pt::Name& name )
+{
+    CategoryRegistry& registry = GetRegistry();
+    pt::MutexLockGuard lock( registry.mutex );
+    auto it = registry.bitsById.find( name.GetId() );
+    if( registry.bitsById.end() != it ){
+        return it->second;
+    }
+
+    size_t index = registry.names.size();
+    if( Category::MaxCount <= index ){
+        std::cout << "Too many logging categories, '" << name << "' shares the switch of the last one\n";
+        index = Category::MaxCount - 1;
+    }
+    const uint64_t bit = uint64_t( 1 ) << index;
+    registry.bitsById[name.GetId()] = bit;
+    registry.names.push_back( name );
+    return bit;
+}
+
+} //end of anonymous namespace
+
+
+std::atomic<uint64_t> pt::log::Category::smEnabledMask( UINT64_MAX );
+
+
+pt::log::Category::
+Category( const pt::Name& name ):
+    mName( name ), mBit( RegisterCategory( name ) )
+{}
+
+
+pt::log::Category::
+~Category()
+{}
+
+
+void pt::log::Category::
+SetEnabled( bool enabled ) const
+{
+    if( enabled ){
+        smEnabledMask.fetch_or( mBit, std::memory_order_relaxed );
+    }else{
+        smEnabledMask.fetch_and( ~mBit, std::memory_order_relaxed );
+    }
+}
+
+
+void pt::log::Category::
+SetAllEnabled( bool enabled )
+{
+    smEnabledMask.store( enabled ? UINT64_MAX : 0, std::memory_order_relaxed );
+}
+
+
+std::vector<pt::Name> pt::log::Category::
+GetRegisteredNames()
+{
+    CategoryRegistry& registry = GetRegistry();
+    pt::MutexLockGuard lock( registry.mutex );
+    return registry.names;
+}
+
+
+void pt::log::
+SetCategoryEnabled( const pt::Name& name, bool enabled )
+{
+    Category( name ).SetEnabled( enabled );
+}
+
+
+bool pt::log::
+IsCategoryEnabled( const pt::Name& name )
+{
+    return Category( name ).IsEnabled();
+}
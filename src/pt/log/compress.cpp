@@ -0,0 +1,320 @@
+#include "pt/log/compress.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace pt::log;
+
+const char* const pt::log::CompressedFileExtension = ".lz";
+
+static const char       gMagic[4]       = { 'P', 'T', 'L', 'Z' };
+static const uint8_t    gVersion        = 1;
+static const size_t     gBlockSize      = 1024 * 1024;
+static const uint32_t   gStoredFlag     = 0x80000000u;
+
+static const size_t     gMinMatch       = 4;
+static const size_t     gMaxOffset      = 65535;
+static const int        gHashBits       = 14;
+// the end of a block is always stored as literals (keeps the decoder's bound checks simple)
+static const size_t     gLastLiterals   = 5;
+static const size_t     gMatchSearchEnd = 12;
+
+
+static uint32_t
+Hash4( const uint8_t* data )
+{
+    uint32_t value;
+    memcpy( &value, data, sizeof(value) );
+    return ( value * 2654435761u ) >> ( 32 - gHashBits );
+}
+
+
+static void
+PutU32( std::string& out, uint32_t value )
+{
+    char bytes[4] = { char( value & 0xFF ), char( (value >> 8) & 0xFF ),
+                      char( (value >> 16) & 0xFF ), char( (value >> 24) & 0xFF ) };
+    out.append( bytes, sizeof(bytes) );
+}
+
+
+static bool
+GetU32( const uint8_t*& data, const uint8_t* end, uint32_t& value )
+{
+    if( end - data < 4 ){
+        return false;
+    }
+    value = uint32_t( data[0] ) | ( uint32_t( data[1] ) << 8 )
+          | ( uint32_t( data[2] ) << 16 ) | ( uint32_t( data[3] ) << 24 );
+    data += 4;
+    return true;
+}
+
+
+// lengths above 14 continue in extra bytes of 255 (and a final byte below 255)
+static void
+PutLengthExtension( std::string& out, size_t length )
+{
+    while( 255 <= length ){
+        out.push_back( char( 255 ) );
+        length -= 255;
+    }
+    out.push_back( char( length ) );
+}
+
+
+static bool
+GetLengthExtension( const uint8_t*& data, const uint8_t* end, size_t& length )
+{
+    uint8_t byte;
+    do{
+        if( end <= data ){
+            return false;
+        }
+        byte = *data++;
+        length += byte;
+    }while( 255 == byte );
+    return true;
+}
+
+
+static void
+PutSequence( std::string& out, const uint8_t* literals, size_t literal_length,
+             size_t offset, size_t match_length )
+{
+    const size_t match_code = ( 0 < match_length ) ? match_length - gMinMatch : 0;
+    const uint8_t token = uint8_t( ( std::min<size_t>( literal_length, 15 ) << 4 )
+                                   | std::min<size_t>( match_code, 15 ) );
+    out.push_back( char( token ) );
+    if( 15 <= literal_length ){
+        PutLengthExtension( out, literal_length - 15 );
+    }
+    out.append( reinterpret_cast<const char*>( literals ), literal_length );
+
+    if( 0 == match_length ){
+        return;
+    }
+    out.push_back( char( offset & 0xFF ) );
+    out.push_back( char( (offset >> 8) & 0xFF ) );
+    if( 15 <= match_code ){
+        PutLengthExtension( out, match_code - 15 );
+    }
+}
+
+
+static void
+CompressBlock( const uint8_t* src, size_t length, std::vector<uint32_t>& table, std::string& out )
+{
+    std::fill( table.begin(), table.end(), UINT32_MAX );
+
+    size_t anchor = 0;
+    size_t pos    = 0;
+    const size_t search_end = ( gMatchSearchEnd < length ) ? length - gMatchSearchEnd : 0;
+    const size_t match_end  = length - std::min( length, gLastLiterals );
+
+    while( pos < search_end ){
+        const uint32_t hash      = Hash4( src + pos );
+        const uint32_t candidate = table[hash];
+        table[hash] = uint32_t( pos );
+
+        if( (UINT32_MAX == candidate) || (gMaxOffset < pos - candidate)
+            || (0 != memcmp( src + candidate, src + pos, gMinMatch )) )
+        {
+            ++pos;
+            continue;
+        }
+
+        size_t match_length = gMinMatch;
+        while( (pos + match_length < match_end) && (src[candidate + match_length] == src[pos + match_length]) ){
+            ++match_length;
+        }
+        PutSequence( out, src + anchor, pos - anchor, pos - candidate, match_length );
+        pos   += match_length;
+        anchor = pos;
+    }
+    PutSequence( out, src + anchor, length - anchor, 0, 0 );
+}
+
+
+static bool
+DecompressBlock( const uint8_t* src, size_t length, size_t raw_size, std::string& out )
+{
+    const uint8_t* end   = src + length;
+    const size_t   start = out.size();
+    const size_t   limit = start + raw_size;
+
+    while( src < end ){
+        const uint8_t token = *src++;
+
+        size_t literal_length = token >> 4;
+        if( (15 == literal_length) && !GetLengthExtension( src, end, literal_length ) ){
+            return false;
+        }
+        if( (size_t( end - src ) < literal_length) || (limit - out.size() < literal_length) ){
+            return false;
+        }
+        out.append( reinterpret_cast<const char*>( src ), literal_length );
+        src += literal_length;
+
+        // the last sequence has no match
+        if( end == src ){
+            break;
+        }
+
+        if( end - src < 2 ){
+            return false;
+        }
+        const size_t offset = size_t( src[0] ) | ( size_t( src[1] ) << 8 );
+        src += 2;
+        size_t match_length = token & 0x0F;
+        if( (15 == match_length) && !GetLengthExtension( src, end, match_length ) ){
+            return false;
+        }
+        match_length += gMinMatch;
+
+        if( (0 == offset) || (out.size() - start < offset) || (limit - out.size() < match_length) ){
+            return false;
+        }
+        // byte by byte, the match may overlap the bytes it produces
+        size_t from = out.size() - offset;
+        for( size_t i=0; i<match_length; ++i ){
+            out.push_back( out[from + i] );
+        }
+    }
+    return out.size() == limit;
+}
+
+
+void pt::log::
+Compress( const char* data, size_t length, std::string& out )
+{
+    out.append( gMagic, sizeof(gMagic) );
+    out.push_back( char( gVersion ) );
+
+    std::vector<uint32_t> table( size_t(1) << gHashBits );
+    std::string           block;
+    const uint8_t*        src = reinterpret_cast<const uint8_t*>( data );
+    while( 0 < length ){
+        const size_t raw_size = std::min( length, gBlockSize );
+        block.clear();
+        CompressBlock( src, raw_size, table, block );
+
+        PutU32( out, uint32_t( raw_size ) );
+        if( raw_size <= block.size() ){
+            PutU32( out, uint32_t( raw_size ) | gStoredFlag );
+            out.append( reinterpret_cast<const char*>( src ), raw_size );
+        }else{
+            PutU32( out, uint32_t( block.size() ) );
+            out.append( block );
+        }
+        src    += raw_size;
+        length -= raw_size;
+    }
+    PutU32( out, 0 );
+}
+
+
+bool pt::log::
+Decompress( const char* data, size_t length, std::string& out )
+{
+    const uint8_t* src = reinterpret_cast<const uint8_t*>( data );
+    const uint8_t* end = src + length;
+    if( (length < sizeof(gMagic) + 1) || (0 != memcmp( src, gMagic, sizeof(gMagic) ))
+        || (gVersion != src[sizeof(gMagic)]) )
+    {
+        return false;
+    }
+    src += sizeof(gMagic) + 1;
+
+    for(;;){
+        uint32_t raw_size;
+        uint32_t stored_size;
+        if( !GetU32( src, end, raw_size ) ){
+            return false;
+        }
+        if( 0 == raw_size ){
+            return true;
+        }
+        if( (gBlockSize < raw_size) || !GetU32( src, end, stored_size ) ){
+            return false;
+        }
+
+        const bool   stored = ( 0 != (stored_size & gStoredFlag) );
+        const size_t size   = stored_size & ~gStoredFlag;
+        if( size_t( end - src ) < size ){
+            return false;
+        }
+        if( stored ){
+            if( size != raw_size ){
+                return false;
+            }
+            out.append( reinterpret_cast<const char*>( src ), size );
+        }else if( !DecompressBlock( src, size, raw_size, out ) ){
+            return false;
+        }
+        src += size;
+    }
+}
+
+
+static bool
+ReadWholeFile( const std::string& path, std::string& contents )
+{
+    FILE* file = fopen( path.c_str(), "rb" );
+    if( nullptr == file ){
+        return false;
+    }
+    char buffer[64 * 1024];
+    size_t count;
+    while( 0 < ( count = fread( buffer, 1, sizeof(buffer), file ) ) ){
+        contents.append( buffer, count );
+    }
+    bool success = ( 0 == ferror( file ) );
+    fclose( file );
+    return success;
+}
+
+
+static bool
+WriteWholeFile( const std::string& path, const std::string& contents )
+{
+    FILE* file = fopen( path.c_str(), "wb" );
+    if( nullptr == file ){
+        return false;
+    }
+    bool success = ( contents.size() == fwrite( contents.data(), 1, contents.size(), file ) );
+    success &= ( 0 == fclose( file ) );
+    return success;
+}
+
+
+bool pt::log::
+CompressFile( const std::string& src_path, const std::string& dst_path )
+{
+    std::string contents;
+    if( !ReadWholeFile( src_path, contents ) ){
+        return false;
+    }
+    std::string compressed;
+    compressed.reserve( contents.size() / 2 );
+    Compress( contents.data(), contents.size(), compressed );
+    return WriteWholeFile( dst_path, compressed );
+}
+
+
+bool pt::log::
+DecompressFile( const std::string& src_path, const std::string& dst_path )
+{
+    std::string contents;
+    if( !ReadWholeFile( src_path, contents ) ){
+        return false;
+    }
+    std::string decompressed;
+    if( !Decompress( contents.data(), contents.size(), decompressed ) ){
+        return false;
+    }
+    return WriteWholeFile( dst_path, decompressed );
+}
@@ -0,0 +1,236 @@
+#include "pt/log/crashhandler.h"
+
+#include "pt/def.h"
+#include "pt/log/backend.h"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+
+#ifdef PT_PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+using namespace pt::log;
+
+
+void pt::log::
+EmergencyWrite( int fd, const char* data, size_t length )
+{
+    while( 0 < length ){
+        auto result = ::write( fd, data, length );
+        if( result < 0 ){
+            if( EINTR == errno ){
+                continue;
+            }
+            return;
+        }
+        data   += result;
+        length -= result;
+    }
+}
+
+
+#ifdef PT_PLATFORM_LINUX
+
+namespace{
+
+const int           gFatalSignals[]     = { SIGSEGV, SIGABRT, SIGBUS };
+const size_t        gFatalSignalCount   = sizeof(gFatalSignals) / sizeof(gFatalSignals[0]);
+const int           gMaxStackFrames     = 64;
+const size_t        gAltStackSize       = 64 * 1024;    // 'SIGSTKSZ' is not a constant in newer glibc versions
+
+struct sigaction    gPreviousActions[gFatalSignalCount];
+bool                gInstalled = false;
+std::atomic<bool>   gHandlingCrash( false );
+alignas(16) char    gAltStack[gAltStackSize];
+
+
+const char*
+GetSignalName( int signal )
+{
+    switch( signal ){
+    case SIGSEGV: return "SIGSEGV";
+    case SIGABRT: return "SIGABRT";
+    case SIGBUS:  return "SIGBUS";
+    }
+    return "unknown";
+}
+
+
+// 'snprintf()' is not async-signal-safe
+size_t
+AppendUnsigned( char* out, uint64_t value )
+{
+    char   digits[20];
+    size_t count = 0;
+    do{
+        digits[count++] = static_cast<char>( '0' + value % 10 );
+        value /= 10;
+    }while( 0 < value );
+
+    for( size_t i=0; i<count; ++i ){
+        out[i] = digits[count-1-i];
+    }
+    return count;
+}
+
+
+size_t
+AppendString( char* out, const char* str )
+{
+    const size_t length = strlen( str );
+    memcpy( out, str, length );
+    return length;
+}
+
+
+void
+RestorePreviousAction( int signal )
+{
+    for( size_t i=0; i<gFatalSignalCount; ++i ){
+        if( signal != gFatalSignals[i] ){
+            continue;
+        }
+        struct sigaction action = gPreviousActions[i];
+        // an ignored fault would be re-executed forever
+        if( SIG_IGN == action.sa_handler ){
+            action.sa_handler = SIG_DFL;
+        }
+        sigaction( signal, &action, nullptr );
+        return;
+    }
+}
+
+
+void
+HandleFatalSignal( int signal, siginfo_t* info, void* context )
+{
+    if( !gHandlingCrash.exchange( true ) ){
+        char   header[128];
+        size_t length = AppendString( header, "ptlib: fatal signal " );
+        length += AppendUnsigned( header + length, signal );
+        length += AppendString( header + length, " (" );
+        length += AppendString( header + length, GetSignalName( signal ) );
+        length += AppendString( header + length, "), pending log records follow\n" );
+
+        EmergencyWrite( STDERR_FILENO, header, length );
+        Backend& backend = GetBackend();
+        backend.EmergencyFlush( header, length );
+
+        // the first 'backtrace()' call may allocate, it is done already in 'InstallCrashHandler()'
+        void* frames[gMaxStackFrames];
+        const int   frame_count = backtrace( frames, gMaxStackFrames );
+        const char  trace_header[] = "ptlib: stack trace:\n";
+        const int   fd = backend.GetEmergencyDescriptor();
+        if( 0 <= fd ){
+            EmergencyWrite( fd, trace_header, sizeof(trace_header)-1 );
+            backtrace_symbols_fd( frames, frame_count, fd );
+        }
+        EmergencyWrite( STDERR_FILENO, trace_header, sizeof(trace_header)-1 );
+        backtrace_symbols_fd( frames, frame_count, STDERR_FILENO );
+    }
+
+    RestorePreviousAction( signal );
+    // sent by 'kill()', 'raise()' or 'abort()': resend it
+    //   otherwise returning re-executes the faulting instruction under the previous handler
+    if( (SIGABRT == signal) || (nullptr == info) || (info->si_code <= 0) ){
+        raise( signal );
+    }
+}
+
+} //end of anonymous namespace
+
+
+bool pt::log::
+InstallCrashHandler()
+{
+    if( gInstalled ){
+        return true;
+    }
+
+    // loads the unwinder library now, instead of in the handler
+    void* frame;
+    backtrace( &frame, 1 );
+
+    stack_t alt_stack;
+    memset( &alt_stack, 0, sizeof(alt_stack) );
+    alt_stack.ss_sp    = gAltStack;
+    alt_stack.ss_size  = gAltStackSize;
+    alt_stack.ss_flags = 0;
+    sigaltstack( &alt_stack, nullptr );
+
+    struct sigaction action;
+    memset( &action, 0, sizeof(action) );
+    action.sa_sigaction = HandleFatalSignal;
+    action.sa_flags     = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset( &action.sa_mask );
+
+    for( size_t i=0; i<gFatalSignalCount; ++i ){
+        if( 0 != sigaction( gFatalSignals[i], &action, &gPreviousActions[i] ) ){
+            // roll back the already installed ones
+            for( size_t j=0; j<i; ++j ){
+                sigaction( gFatalSignals[j], &gPreviousActions[j], nullptr );
+            }
+            return false;
+        }
+    }
+    gHandlingCrash = false;
+    gInstalled = true;
+    return true;
+}
+
+
+void pt::log::
+UninstallCrashHandler()
+{
+    if( !gInstalled ){
+        return;
+    }
+    for( size_t i=0; i<gFatalSignalCount; ++i ){
+        sigaction( gFatalSignals[i], &gPreviousActions[i], nullptr );
+    }
+
+    stack_t alt_stack;
+    memset( &alt_stack, 0, sizeof(alt_stack) );
+    alt_stack.ss_flags = SS_DISABLE;
+    sigaltstack( &alt_stack, nullptr );
+    gInstalled = false;
+}
+
+
+bool pt::log::
+IsCrashHandlerInstalled()
+{
+    return gInstalled;
+}
+
+
+#else
+
+
+bool pt::log::
+InstallCrashHandler()
+{
+    return false;
+}
+
+
+void pt::log::
+UninstallCrashHandler()
+{}
+
+
+bool pt::log::
+IsCrashHandlerInstalled()
+{
+    return false;
+}
+
+
+#endif
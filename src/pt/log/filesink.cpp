@@ -0,0 +1,278 @@
+#include "pt/log/filesink.h"
+
+#include "pt/def.h"
+#include "pt/log/compress.h"
+#include "pt/log/crashhandler.h"
+#include "pt/log/logstream.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef PT_PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace pt::log;
+
+
+namespace{
+
+// permissions of created log files
+#ifdef PT_PLATFORM_WINDOWS
+const int gFileMode = _S_IREAD | _S_IWRITE;
+#else
+const int gFileMode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+#endif
+
+} //end of anonymous namespace
+
+
+pt::log::FileSink::
+FileSink()
+{}
+
+
+pt::log::FileSink::
+~FileSink()
+{
+    Close();
+}
+
+
+bool pt::log::FileSink::
+Open( const std::string& path, size_t buffer_size )
+{
+    Close();
+
+    int fd = ::open( path.c_str(), O_WRONLY | O_CREAT | O_APPEND, gFileMode );
+    if( fd < 0 ){
+        std::cout << "Failed to open log file '" << path << "', errno(" << errno << ")\n";
+        return false;
+    }
+
+    struct stat file_stat;
+    mFileSize = ( 0 == ::fstat( fd, &file_stat ) ) ? file_stat.st_size : 0;
+
+    mFileDescriptor = fd;
+    mPath = path;
+    mBuffer.resize( buffer_size );
+    mBufferUsed = 0;
+    mAtLineStart = true;
+    // continues after the rotated files of earlier runs, retention deletes the lowest indices first
+    const auto rotated_files = FindRotatedFiles( path );
+    mNextRotationIndex = rotated_files.empty() ? 1 : rotated_files.rbegin()->first + 1;
+    ScheduleNextRotation_();
+    return true;
+}
+
+
+void pt::log::FileSink::
+Close()
+{
+    if( !IsOpen() ){
+        return;
+    }
+    Flush();
+    ::close( mFileDescriptor );
+    mFileDescriptor = -1;
+}
+
+
+bool pt::log::FileSink::
+IsOpen() const
+{
+    return ( 0 <= mFileDescriptor );
+}
+
+
+void pt::log::FileSink::
+Write( const char* data, size_t length )
+{
+    if( !IsOpen() || (0 == length) ){
+        return;
+    }
+
+    if( mAtLineStart && mRotation.IsEnabled() && IsRotationDue_( length ) ){
+        Rotate_();
+    }
+    mAtLineStart = ( '\n' == data[length-1] );
+    mFileSize += length;
+
+    if( mBuffer.size() < mBufferUsed + length ){
+        Flush();
+        // doesn't fit even into an empty buffer, skip the copy
+        if( mBuffer.size() < length ){
+            WriteToFile_( data, length );
+            return;
+        }
+    }
+    memcpy( mBuffer.data() + mBufferUsed, data, length );
+    mBufferUsed += length;
+}
+
+
+void pt::log::FileSink::
+Write( const std::string& str )
+{
+    Write( str.data(), str.length() );
+}
+
+
+void pt::log::FileSink::
+Write( const LogRecord& record )
+{
+    mHeaderScratch.clear();
+    AppendLineHeader( record, mHeaderScratch );
+    Write( mHeaderScratch );
+    Write( record.text );
+}
+
+
+void pt::log::FileSink::
+Flush()
+{
+    if( 0 < mBufferUsed ){
+        WriteToFile_( mBuffer.data(), mBufferUsed );
+        mBufferUsed = 0;
+    }
+}
+
+
+void pt::log::FileSink::
+SetRotation( const RotationSettings& settings )
+{
+    mRotation = settings;
+    ScheduleNextRotation_();
+}
+
+
+const RotationSettings& pt::log::FileSink::
+GetRotation() const
+{
+    return mRotation;
+}
+
+
+size_t pt::log::FileSink::
+GetBufferSize() const
+{
+    return mBuffer.size();
+}
+
+
+size_t pt::log::FileSink::
+GetBufferedBytes() const
+{
+    return mBufferUsed;
+}
+
+
+const std::string& pt::log::FileSink::
+GetPath() const
+{
+    return mPath;
+}
+
+
+void pt::log::FileSink::
+EmergencyFlush() const
+{
+    // the writer thread may be in the middle of a write, read the fill level only once
+    const size_t used = mBufferUsed;
+    if( IsOpen() && (0 < used) && (used <= mBuffer.size()) ){
+        EmergencyWrite( mFileDescriptor, mBuffer.data(), used );
+    }
+}
+
+
+int pt::log::FileSink::
+GetFileDescriptor() const
+{
+    return mFileDescriptor;
+}
+
+
+void pt::log::FileSink::
+WriteToFile_( const char* data, size_t length )
+{
+    while( 0 < length ){
+        auto result = ::write( mFileDescriptor, data, length );
+        if( result < 0 ){
+            if( EINTR == errno ){
+                continue;
+            }
+            std::cout << "Failed to write log file '" << mPath << "', errno(" << errno << ")\n";
+            return;
+        }
+        data   += result;
+        length -= result;
+    }
+}
+
+
+bool pt::log::FileSink::
+IsRotationDue_( size_t incoming_length ) const
+{
+    // an empty file is never rotated
+    if( 0 == mFileSize ){
+        return false;
+    }
+    if( (0 < mRotation.maxFileSize) && (mRotation.maxFileSize < mFileSize + incoming_length) ){
+        return true;
+    }
+    return ( 0 < mRotation.intervalSeconds ) && ( mNextRotationTime <= std::time( nullptr ) );
+}
+
+
+void pt::log::FileSink::
+Rotate_()
+{
+    Flush();
+    ::close( mFileDescriptor );
+    mFileDescriptor = -1;
+
+    // skip the indices of files created since 'Open()'
+    std::string rotated_path;
+    struct stat file_stat;
+    do{
+        rotated_path = mPath + "." + std::to_string( mNextRotationIndex++ );
+    }while( (0 == ::stat( rotated_path.c_str(), &file_stat ))
+            || (0 == ::stat( (rotated_path + CompressedFileExtension).c_str(), &file_stat )) );
+
+    if( 0 == std::rename( mPath.c_str(), rotated_path.c_str() ) ){
+        GetRotationWorker().Enqueue( mPath, rotated_path, mRotation );
+    }else{
+        std::cout << "Failed to rotate log file '" << mPath << "', errno(" << errno << ")\n";
+    }
+
+    int fd = ::open( mPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, gFileMode );
+    if( fd < 0 ){
+        std::cout << "Failed to reopen log file '" << mPath << "', errno(" << errno << ")\n";
+        return;
+    }
+    mFileDescriptor = fd;
+    mFileSize = ( 0 == ::fstat( fd, &file_stat ) ) ? file_stat.st_size : 0;
+    ScheduleNextRotation_();
+}
+
+
+void pt::log::FileSink::
+ScheduleNextRotation_()
+{
+    if( 0 == mRotation.intervalSeconds ){
+        return;
+    }
+    // aligned to the interval (eg.: hourly rotation happens at every full hour)
+    const int64_t interval = mRotation.intervalSeconds;
+    const int64_t now      = std::time( nullptr );
+    mNextRotationTime = ( now / interval + 1 ) * interval;
+}
@@ -0,0 +1,225 @@
+#include "pt/log/kvrecord.h"
+
+#include "pt/alias.h"
+#include "pt/log/timestamp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string_view>
+
+using namespace pt::log;
+using namespace pt::log::binary;
+
+// deque: registered entries never move, their addresses are handed out
+static std::mutex                   gKeyValueSiteMutex;
+static std::deque< KeyValueSite >   gKeyValueSites;
+static std::atomic<uint8_t>         gKeyValueFormat( static_cast<uint8_t>( KeyValueFormat::Json ) );
+
+
+void pt::log::
+SetKeyValueFormat( KeyValueFormat format )
+{
+    gKeyValueFormat = static_cast<uint8_t>( format );
+}
+
+
+KeyValueFormat pt::log::
+GetKeyValueFormat()
+{
+    return static_cast<KeyValueFormat>( gKeyValueFormat.load( std::memory_order_relaxed ) );
+}
+
+
+uint32_t pt::log::
+RegisterKeyValueSite( const char* file, int line, std::vector<pt::Name>&& keys )
+{
+    KeyValueSite site;
+    site.file = ( nullptr != file ) ? file : "";
+    site.line = line;
+    site.keys = std::move( keys );
+    for( const auto& key : site.keys ){
+        key.Init();
+    }
+
+    pt::MutexLockGuard lock( gKeyValueSiteMutex );
+    gKeyValueSites.push_back( std::move( site ) );
+    return static_cast<uint32_t>( gKeyValueSites.size() - 1 );
+}
+
+
+const KeyValueSite* pt::log::
+GetKeyValueSite( uint32_t site_id )
+{
+    pt::MutexLockGuard lock( gKeyValueSiteMutex );
+    if( gKeyValueSites.size() <= site_id ){
+        return nullptr;
+    }
+    return &gKeyValueSites[site_id];
+}
+
+
+namespace{
+
+// the shortest of 15-17 significant digits, that reads back as the same value ('%g' only keeps 6 digits)
+void
+AppendFloat( double value, std::string& out )
+{
+    char buffer[32];
+    int  length = 0;
+    for( int precision=15; precision<=17; ++precision ){
+        length = snprintf( buffer, sizeof(buffer), "%.*g", precision, value );
+        if( std::strtod( buffer, nullptr ) == value ){
+            break;
+        }
+    }
+    if( 0 < length ){
+        out.append( buffer, std::min<size_t>( length, sizeof(buffer)-1 ) );
+    }
+}
+
+
+void
+AppendJsonString( std::string_view str, std::string& out )
+{
+    static const char* const hex = "0123456789abcdef";
+    out.push_back( '"' );
+    for( char c : str ){
+        switch( c ){
+        case '"':   out.append( "\\\"" ); break;
+        case '\\':  out.append( "\\\\" ); break;
+        case '\n':  out.append( "\\n" );  break;
+        case '\r':  out.append( "\\r" );  break;
+        case '\t':  out.append( "\\t" );  break;
+        default:
+            if( static_cast<unsigned char>( c ) < 0x20 ){
+                out.append( "\\u00" );
+                out.push_back( hex[(c >> 4) & 0x0F] );
+                out.push_back( hex[c & 0x0F] );
+            }else{
+                out.push_back( c );
+            }
+        }
+    }
+    out.push_back( '"' );
+}
+
+
+void
+AppendJsonValue( const ArgValue& value, std::string& out )
+{
+    switch( value.type ){
+    case ArgType::Bool:
+        out.append( value.boolValue ? "true" : "false" );
+        return;
+    case ArgType::Int:
+    case ArgType::UInt:
+        AppendArgText( value, out );
+        return;
+    case ArgType::Float:
+        // JSON has no representation for these
+        if( std::isfinite( value.floatValue ) ){
+            AppendFloat( value.floatValue, out );
+        }else{
+            out.append( "null" );
+        }
+        return;
+    case ArgType::Char:
+    case ArgType::String:
+    case ArgType::Name:
+    case ArgType::Pointer:{
+        std::string text;
+        AppendArgText( value, text );
+        AppendJsonString( text, out );
+        return;
+    }
+    }
+}
+
+
+void
+AppendLogfmtValue( const ArgValue& value, std::string& out )
+{
+    std::string text;
+    if( ArgType::Float == value.type ){
+        AppendFloat( value.floatValue, text );
+    }else{
+        AppendArgText( value, text );
+    }
+    bool needs_quotes = text.empty();
+    for( char c : text ){
+        if( (' ' == c) || ('=' == c) || ('"' == c) || (static_cast<unsigned char>( c ) < 0x20) ){
+            needs_quotes = true;
+            break;
+        }
+    }
+    if( needs_quotes ){
+        AppendJsonString( text, out );
+    }else{
+        out.append( text );
+    }
+}
+
+} //end of anonymous namespace
+
+
+KeyValueFormat pt::log::
+FormatKeyValueRecord( const std::string& payload, int64_t timestamp,
+                      const std::string& prefix, std::string& out )
+{
+    PayloadReader       reader( payload );
+    uint32_t            site_id;
+    uint8_t             format_id = 0;
+    const KeyValueSite* site = nullptr;
+    if( reader.Read( site_id ) && reader.Read( format_id ) ){
+        site = GetKeyValueSite( site_id );
+    }
+
+    const KeyValueFormat format = ( static_cast<uint8_t>( KeyValueFormat::Logfmt ) == format_id )
+                                  ? KeyValueFormat::Logfmt : KeyValueFormat::Json;
+    const bool json = ( KeyValueFormat::Json == format );
+    if( json ){
+        thread_local TimestampFormatter tlFormatter;
+        char time[TimestampFormatter::Length];
+        tlFormatter.Format( timestamp, time );
+        out.append( "{\"time\":\"" );
+        out.append( time, sizeof(time) );
+        out.append( "\",\"stream\":" );
+        AppendJsonString( prefix, out );
+    }
+
+    bool     valid = ( nullptr != site );
+    ArgValue value;
+    for( size_t i=0; valid && (i < site->keys.size()); ++i ){
+        valid = ReadArg( reader, value );
+        if( !valid ){
+            break;
+        }
+        if( json ){
+            out.push_back( ',' );
+            AppendJsonString( site->keys[i].GetStringView(), out );
+            out.push_back( ':' );
+            AppendJsonValue( value, out );
+        }else{
+            if( 0 < i ){
+                out.push_back( ' ' );
+            }
+            out.append( site->keys[i].GetStringView() );
+            out.push_back( '=' );
+            AppendLogfmtValue( value, out );
+        }
+    }
+
+    if( !valid ){
+        out.append( json ? ",\"error\":\"malformed key-value record\"" : " error=\"malformed key-value record\"" );
+    }
+    if( json ){
+        out.push_back( '}' );
+    }
+    out.push_back( '\n' );
+    return format;
+}
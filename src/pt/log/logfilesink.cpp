@@ -0,0 +1,239 @@
+#include "pt/log/logfilesink.h"
+
+#include "pt/def.h"
+#include "pt/logging.h"
+#include "pt/log/crashhandler.h"
+#include "pt/log/logstream.hpp"
+
+#include <iostream>
+
+#ifdef PT_PLATFORM_WINDOWS
+#include <io.h>
+#ifndef STDERR_FILENO
+#define STDERR_FILENO 2
+#endif
+#else
+#include <unistd.h>
+#endif
+
+using namespace pt::log;
+
+// liveness of the logger daemon is checked this often
+static const std::chrono::milliseconds gDaemonCheckInterval( 1000 );
+
+
+static bool
+IsFileOutputEnabled()
+{
+    //TODO: Windows file output stays disabled until Unicode paths are handled (see 'known_issues.txt')
+    #ifdef PT_PLATFORM_LINUX
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+
+pt::log::LogFileSink::
+LogFileSink():
+    mDaemonConnected( false )
+{}
+
+
+pt::log::LogFileSink::
+~LogFileSink()
+{
+    Close();
+}
+
+
+bool pt::log::LogFileSink::
+Open( const std::string& path, size_t buffer_size,
+      const std::string& daemon_name, uint32_t daemon_timeout_ms,
+      const RotationSettings& rotation, FileMode file_mode )
+{
+    Close();
+    mFile.SetRotation( rotation );
+    mFileMode        = file_mode;
+    mPath            = path;
+    mBufferSize      = buffer_size;
+    mDaemonName      = daemon_name;
+    mDaemonTimeoutMs = daemon_timeout_ms;
+
+    if( 0 < mDaemonName.length() ){
+        if( mDaemonRing.Attach( mDaemonName, mDaemonTimeoutMs ) ){
+            mDaemonConnected = true;
+            mLastDaemonCheck = std::chrono::steady_clock::now();
+        }else{
+            std::cout << "Logger daemon '" << mDaemonName << "' is not available, logging locally\n";
+        }
+    }
+
+    if( !mDaemonConnected && !EnsureLocalFile_() ){
+        return false;
+    }
+    mOpen = true;
+    return true;
+}
+
+
+void pt::log::LogFileSink::
+Close()
+{
+    if( !mOpen ){
+        return;
+    }
+    Flush();
+    mFile.Close();
+    mMappedFile.Close();
+    mDaemonRing.Close();
+    mDaemonConnected = false;
+    mOpen = false;
+}
+
+
+bool pt::log::LogFileSink::
+IsOpen() const
+{
+    return mOpen;
+}
+
+
+bool pt::log::LogFileSink::
+IsConnectedToDaemon() const
+{
+    return mDaemonConnected;
+}
+
+
+void pt::log::LogFileSink::
+Write( const LogRecord& record )
+{
+    if( !mOpen ){
+        WriteUnopened_( record );
+        return;
+    }
+    if( WriteToDaemon_( record ) ){
+        return;
+    }
+    if( mMappedFile.IsOpen() ){
+        mMappedFile.Write( record );
+    }else{
+        mFile.Write( record );
+    }
+}
+
+
+void pt::log::LogFileSink::
+Flush()
+{
+    mFile.Flush();
+    if( mDaemonNotifyPending ){
+        mDaemonRing.Notify();
+        mDaemonNotifyPending = false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if( mDaemonConnected && (gDaemonCheckInterval <= now - mLastDaemonCheck) ){
+        CheckDaemon_();
+        mLastDaemonCheck = now;
+    }
+}
+
+
+void pt::log::LogFileSink::
+EmergencyFlush()
+{
+    mFile.EmergencyFlush();
+}
+
+
+void pt::log::LogFileSink::
+EmergencyWrite( const char* data, size_t length )
+{
+    if( mDaemonConnected && mDaemonRing.TryWrite( data, length ) ){
+        mDaemonRing.Notify();
+        return;
+    }
+    if( mMappedFile.IsOpen() ){
+        mMappedFile.EmergencyWrite( data, length );
+        return;
+    }
+    const int fd = mFile.GetFileDescriptor();
+    pt::log::EmergencyWrite( (0 <= fd) ? fd : STDERR_FILENO, data, length );
+}
+
+
+int pt::log::LogFileSink::
+GetEmergencyDescriptor()
+{
+    if( mMappedFile.IsOpen() ){
+        return mMappedFile.EmergencyTrim();
+    }
+    return mFile.GetFileDescriptor();
+}
+
+
+bool pt::log::LogFileSink::
+WriteToDaemon_( const LogRecord& record )
+{
+    if( !mDaemonConnected ){
+        return false;
+    }
+
+    mScratch.clear();
+    AppendLineHeader( record, mScratch );
+    mScratch.append( record.text );
+
+    if( mDaemonRing.TryWrite( mScratch.data(), mScratch.length() ) ){
+        mDaemonNotifyPending = true;
+        return true;
+    }
+
+    // the daemon is not keeping up, write locally instead of blocking
+    EnsureLocalFile_();
+    return false;
+}
+
+
+void pt::log::LogFileSink::
+WriteUnopened_( const LogRecord& record )
+{
+    // not initialized yet or already destroyed
+    const std::string& fname = pt::log::GetFileName();
+    if( IsFileOutputEnabled() && (0 < fname.length()) ){
+        FileSink sink;
+        if( sink.Open( fname, 0 ) ){
+            sink.Write( record );
+        }
+    }
+}
+
+
+void pt::log::LogFileSink::
+CheckDaemon_()
+{
+    if( mDaemonConnected && !mDaemonRing.IsConsumerAlive( mDaemonTimeoutMs ) ){
+        std::cout << "Logger daemon '" << mDaemonName << "' stopped responding, logging locally\n";
+        mDaemonConnected = false;
+        mDaemonNotifyPending = false;
+        mDaemonRing.Close();
+        EnsureLocalFile_();
+    }
+}
+
+
+bool pt::log::LogFileSink::
+EnsureLocalFile_()
+{
+    if( mFile.IsOpen() || mMappedFile.IsOpen() || !IsFileOutputEnabled() || (0 == mPath.length()) ){
+        return true;
+    }
+    if( FileMode::Mapped == mFileMode ){
+        if( mMappedFile.Open( mPath ) ){
+            return true;
+        }
+        std::cout << "Failed to map log file '" << mPath << "', using buffered writes\n";
+    }
+    return mFile.Open( mPath, mBufferSize );
+}
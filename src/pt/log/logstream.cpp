@@ -2,6 +2,7 @@
 
 #include "pt/logging.h"
 #include "pt/name.h"
+#include "pt/log/backend.h"
 
 #include <chrono>
 #include <sstream>
@@ -10,6 +11,8 @@
 #include <algorithm>
 #include <stdexcept>
 #include <cstring>
+#include <memory>
+#include <vector>
 
 using namespace pt::log;
 
@@ -21,21 +24,103 @@ getFileName() const
 }
 
 
+namespace{
+
+// holds the message buffers of every logstream for a single thread
+//   unfinished records are committed when the thread exits
+struct ThreadMessageBuffers{
+    std::vector< std::unique_ptr<MessageBuffer> > buffers;
+
+    ~ThreadMessageBuffers(){
+        for( auto& buffer : buffers ){
+            if( buffer && !buffer->IsEmpty() ){
+                GetBackend().Submit( LogRecord( buffer->Owner(), std::string( buffer->Text() ) ) );
+            }
+        }
+    }
+};
+
+} //end of anonymous namespace
+
+
+std::atomic<uint32_t> pt::log::logstream::smNextIndex( 0 );
+std::atomic<size_t>   pt::log::logstream::smMaxElements( 32 );
+
+
+MessageBuffer& pt::log::logstream::
+getMessageBuffer() const
+{
+    thread_local ThreadMessageBuffers tlBuffers;
+
+    if( tlBuffers.buffers.size() <= mIndex ){
+        tlBuffers.buffers.resize( mIndex+1 );
+    }
+    std::unique_ptr<MessageBuffer>& buffer = tlBuffers.buffers[mIndex];
+    if( nullptr == buffer ){
+        buffer = std::unique_ptr<MessageBuffer>( new MessageBuffer( this ) );
+    }
+    return *buffer;
+}
+
+
+void pt::log::logstream::
+commit( MessageBuffer& buffer ) const
+{
+    // copy instead of move, so the buffer keeps its capacity for the next record
+    GetBackend().Submit( LogRecord( this, std::string( buffer.Text() ) ) );
+    buffer.Clear();
+}
+
+
+void pt::log::logstream::
+commitBinary( std::string&& payload, RecordType type ) const
+{
+    GetBackend().Submit( LogRecord( this, std::move( payload ), type ) );
+}
+
+
 pt::log::logstream::
-logstream(): mEnabled(true)
+logstream():
+    mEnabled(true), mIndex( smNextIndex++ ), mSeverity( PT_LOG_LEVEL_INFO ),
+    mOverflowPolicy( OverflowPolicy::Block ), mDroppedSinceReport( 0 ), mDroppedTotal( 0 )
 {}
 
 
 pt::log::logstream::
-logstream(const std::string &prefix):
-    mEnabled(true), mMessagePrefix( prefix )
+logstream( const std::string &prefix, uint8_t severity, OverflowPolicy policy ):
+    mEnabled(true), mMessagePrefix( prefix ), mIndex( smNextIndex++ ), mSeverity( severity ),
+    mOverflowPolicy( policy ), mDroppedSinceReport( 0 ), mDroppedTotal( 0 )
 {}
 
 
+logstream& logstream::
+operator<<( std::streambuf* data ){
+    if( isEnabled() ){
+        MessageBuffer& buffer = getMessageBuffer();
+        buffer.Append( data );
+        if( buffer.EndsLine() ){
+            commit( buffer );
+        }
+    }
+    return *this;
+}
+
+
 logstream& logstream::
 operator<<( const pt::Name& data ){
-    if( mEnabled ){
-        LogMessage<std::string>( data.GetStdString() );
+    if( isEnabled() ){
+        LogMessage<std::string_view>( data.GetStringView() );
+    }
+    return *this;
+}
+
+
+logstream& logstream::
+operator<<( const SendToken& token ){
+    if( isEnabled() ){
+        MessageBuffer& buffer = getMessageBuffer();
+        buffer.Stream() << '\n';
+        commit( buffer );
     }
     return *this;
 }
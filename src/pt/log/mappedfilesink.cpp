@@ -0,0 +1,338 @@
+#include "pt/log/mappedfilesink.h"
+
+#include "pt/def.h"
+#include "pt/log/logstream.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef PT_PLATFORM_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace pt::log;
+
+
+namespace{
+
+#ifdef PT_PLATFORM_LINUX
+
+uint64_t
+GetPageSize()
+{
+    static const uint64_t page_size = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+    return page_size;
+}
+
+
+// async-signal-safe
+void
+WriteAtOffset( int fd, uint64_t offset, const char* data, size_t length )
+{
+    while( 0 < length ){
+        auto result = ::pwrite( fd, data, length, offset );
+        if( result < 0 ){
+            if( EINTR == errno ){
+                continue;
+            }
+            return;
+        }
+        data   += result;
+        length -= result;
+        offset += result;
+    }
+}
+
+
+// a killed process leaves the preallocated tail zeroed, log files never end with zero bytes
+uint64_t
+FindDataEnd( int fd, uint64_t file_size )
+{
+    std::vector<char> block( 64 * 1024 );
+    uint64_t end = file_size;
+    while( 0 < end ){
+        const uint64_t block_start = ( block.size() < end ) ? end - block.size() : 0;
+        const size_t   length      = static_cast<size_t>( end - block_start );
+        if( ::pread( fd, block.data(), length, block_start ) != static_cast<ssize_t>( length ) ){
+            return file_size;
+        }
+        for( size_t i=length; 0 < i; --i ){
+            if( '\0' != block[i-1] ){
+                return block_start + i;
+            }
+        }
+        end = block_start;
+    }
+    return 0;
+}
+
+#endif
+
+} //end of anonymous namespace
+
+
+pt::log::MappedFileSink::
+MappedFileSink():
+    mWritePos( 0 )
+{}
+
+
+pt::log::MappedFileSink::
+~MappedFileSink()
+{
+    Close();
+}
+
+
+#ifdef PT_PLATFORM_LINUX
+
+
+bool pt::log::MappedFileSink::
+Open( const std::string& path, uint64_t chunk_size )
+{
+    Close();
+
+    int fd = ::open( path.c_str(), O_RDWR | O_CREAT,
+                     S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+    if( fd < 0 ){
+        std::cout << "Failed to open log file '" << path << "', errno(" << errno << ")\n";
+        return false;
+    }
+
+    struct stat file_stat;
+    const uint64_t file_size = ( 0 == ::fstat( fd, &file_stat ) ) ? file_stat.st_size : 0;
+
+    // the window has to start at page boundaries
+    const uint64_t page_size = GetPageSize();
+    mChunkSize = std::max( page_size, ( chunk_size + page_size - 1 ) / page_size * page_size );
+    mAllocated = file_size;
+    mWritePos  = FindDataEnd( fd, file_size );
+    mFileDescriptor = fd;
+    mPath = path;
+    return true;
+}
+
+
+void pt::log::MappedFileSink::
+Close()
+{
+    if( !IsOpen() ){
+        return;
+    }
+    if( nullptr != mWindow.data ){
+        ::munmap( mWindow.data, mWindow.end - mWindow.start );
+        mWindow = Window();
+    }
+    if( 0 != ::ftruncate( mFileDescriptor, mWritePos ) ){
+        std::cout << "Failed to trim log file '" << mPath << "', errno(" << errno << ")\n";
+    }
+    ::close( mFileDescriptor );
+    mFileDescriptor = -1;
+    mAllocated = 0;
+    mWritePos = 0;
+}
+
+
+void pt::log::MappedFileSink::
+EmergencyWrite( const char* data, size_t length )
+{
+    if( IsOpen() ){
+        const uint64_t pos = mWritePos.load();
+        WriteAtOffset( mFileDescriptor, pos, data, length );
+        mWritePos.store( pos + length );
+    }
+}
+
+
+int pt::log::MappedFileSink::
+EmergencyTrim()
+{
+    if( !IsOpen() ){
+        return -1;
+    }
+    ::ftruncate( mFileDescriptor, mWritePos );
+    ::lseek( mFileDescriptor, 0, SEEK_END );
+    return mFileDescriptor;
+}
+
+
+void pt::log::MappedFileSink::
+WriteAt_( uint64_t pos, const char* data, size_t length )
+{
+    while( 0 < length ){
+        if( (nullptr != mWindow.data) && (mWindow.start <= pos) && (pos < mWindow.end) ){
+            const size_t count = static_cast<size_t>( std::min<uint64_t>( length, mWindow.end - pos ) );
+            memcpy( mWindow.data + ( pos - mWindow.start ), data, count );
+            pos    += count;
+            data   += count;
+            length -= count;
+            continue;
+        }
+
+        if( !MoveWindow_( pos ) ){
+            // the range is already allocated, only unmapped
+            WriteAtOffset( mFileDescriptor, pos, data, length );
+            return;
+        }
+    }
+}
+
+
+bool pt::log::MappedFileSink::
+MoveWindow_( uint64_t pos )
+{
+    if( (nullptr != mWindow.data) && (pos < mWindow.start) ){
+        return false;
+    }
+
+    const uint64_t start = pos / GetPageSize() * GetPageSize();
+    const uint64_t end   = start + mChunkSize;
+    if( !Reserve_( end ) ){
+        return false;
+    }
+    void* mapping = ::mmap( nullptr, mChunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFileDescriptor, start );
+    if( MAP_FAILED == mapping ){
+        std::cout << "Failed to map log file '" << mPath << "', errno(" << errno << ")\n";
+        return false;
+    }
+
+    if( nullptr != mWindow.data ){
+        ::munmap( mWindow.data, mWindow.end - mWindow.start );
+    }
+    mWindow.data  = static_cast<char*>( mapping );
+    mWindow.start = start;
+    mWindow.end   = end;
+    return true;
+}
+
+
+bool pt::log::MappedFileSink::
+Reserve_( uint64_t end )
+{
+    if( end <= mAllocated ){
+        return true;
+    }
+    const uint64_t allocated = ( end + mChunkSize - 1 ) / mChunkSize * mChunkSize;
+    if( 0 != ::fallocate( mFileDescriptor, 0, mAllocated, allocated - mAllocated ) ){
+        // not supported by the file system, extend it sparse
+        if( 0 != ::ftruncate( mFileDescriptor, allocated ) ){
+            std::cout << "Failed to extend log file '" << mPath << "', errno(" << errno << ")\n";
+            return false;
+        }
+    }
+    mAllocated = allocated;
+    return true;
+}
+
+
+#else
+
+
+bool pt::log::MappedFileSink::
+Open( const std::string& path, uint64_t chunk_size )
+{
+    return false;
+}
+
+void pt::log::MappedFileSink::
+Close()
+{}
+
+void pt::log::MappedFileSink::
+EmergencyWrite( const char* data, size_t length )
+{}
+
+int pt::log::MappedFileSink::
+EmergencyTrim()
+{
+    return -1;
+}
+
+void pt::log::MappedFileSink::
+WriteAt_( uint64_t pos, const char* data, size_t length )
+{}
+
+bool pt::log::MappedFileSink::
+MoveWindow_( uint64_t pos )
+{
+    return false;
+}
+
+bool pt::log::MappedFileSink::
+Reserve_( uint64_t end )
+{
+    return false;
+}
+
+
+#endif
+
+
+bool pt::log::MappedFileSink::
+IsOpen() const
+{
+    return ( 0 <= mFileDescriptor );
+}
+
+
+void pt::log::MappedFileSink::
+Write( const char* data, size_t length )
+{
+    if( !IsOpen() || (0 == length) ){
+        return;
+    }
+    // advanced before copying, so an emergency write of the crash handler can't overwrite the data
+    const uint64_t pos = mWritePos.load();
+    mWritePos.store( pos + length );
+    WriteAt_( pos, data, length );
+}
+
+
+void pt::log::MappedFileSink::
+Write( const std::string& str )
+{
+    Write( str.data(), str.length() );
+}
+
+
+void pt::log::MappedFileSink::
+Write( const LogRecord& record )
+{
+    if( !IsOpen() ){
+        return;
+    }
+    mHeader.clear();
+    AppendLineHeader( record, mHeader );
+
+    const uint64_t pos = mWritePos.load();
+    mWritePos.store( pos + mHeader.length() + record.text.length() );
+    WriteAt_( pos, mHeader.data(), mHeader.length() );
+    WriteAt_( pos + mHeader.length(), record.text.data(), record.text.length() );
+}
+
+
+void pt::log::MappedFileSink::
+Flush()
+{}
+
+
+uint64_t pt::log::MappedFileSink::
+GetWrittenLength() const
+{
+    return mWritePos;
+}
+
+
+const std::string& pt::log::MappedFileSink::
+GetPath() const
+{
+    return mPath;
+}
@@ -0,0 +1,74 @@
+#include "pt/log/messagebuffer.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace pt::log;
+
+// most records fit into this without reallocation
+static const size_t gInitialCapacity = 256;
+
+
+pt::log::MessageBuffer::
+MessageBuffer( const logstream* owner ):
+    mOwner( owner ), mStream( this )
+{
+    mText.reserve( gInitialCapacity );
+}
+
+
+pt::log::MessageBuffer::
+~MessageBuffer()
+{}
+
+
+MessageBuffer::int_type pt::log::MessageBuffer::
+overflow( int_type ch )
+{
+    if( traits_type::eq_int_type( ch, traits_type::eof() ) ){
+        return traits_type::not_eof( ch );
+    }
+    mText.push_back( traits_type::to_char_type( ch ) );
+    return ch;
+}
+
+
+std::streamsize pt::log::MessageBuffer::
+xsputn( const char* s, std::streamsize n )
+{
+    mText.append( s, n );
+    return n;
+}
+
+
+void pt::log::MessageBuffer::
+Append( std::streambuf* source )
+{
+    if( nullptr == source ){
+        return;
+    }
+    // 'in_avail()' is the whole remaining content of string buffers, so those are read in one step
+    const std::streamsize min_chunk = 4096;
+    const size_t          start     = mText.length();
+    for(;;){
+        const std::streamsize chunk  = std::max( source->in_avail(), min_chunk );
+        const size_t          length = mText.length();
+        mText.resize( length + chunk );
+        const std::streamsize count = source->sgetn( &mText[length], chunk );
+        mText.resize( length + std::max<std::streamsize>( count, 0 ) );
+        if( count < chunk ){
+            break;
+        }
+    }
+
+    // the buffer of an 'std::ostringstream' can't be read, only copied
+    //   readable buffers are copied from their get position only, like 'std::ostream' does
+    if( (start == mText.length())
+        && (std::streampos( -1 ) == source->pubseekoff( 0, std::ios::cur, std::ios::in )) )
+    {
+        auto string_buffer = dynamic_cast<std::stringbuf*>( source );
+        if( nullptr != string_buffer ){
+            mText.append( string_buffer->str() );
+        }
+    }
+}
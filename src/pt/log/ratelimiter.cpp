@@ -0,0 +1,55 @@
+#include "pt/log/ratelimiter.h"
+
+#include <chrono>
+
+using namespace pt::log;
+
+static const int64_t gWindowLengthMs = 1000;
+
+
+pt::log::RateLimiter::
+RateLimiter( uint32_t per_second ):
+    mPerSecond( per_second ),
+    mWindowStartMs( GetTimeMs_() ),
+    mCount( 0 ),
+    mSuppressed( 0 )
+{}
+
+
+pt::log::RateLimiter::
+~RateLimiter()
+{}
+
+
+bool pt::log::RateLimiter::
+TryAcquire( uint64_t& suppressed )
+{
+    suppressed = 0;
+    const int64_t now   = GetTimeMs_();
+    int64_t       start = mWindowStartMs.load( std::memory_order_relaxed );
+    if( gWindowLengthMs <= now - start ){
+        // only the thread winning the CAS opens the new window
+        if( mWindowStartMs.compare_exchange_strong( start, now, std::memory_order_relaxed ) ){
+            mCount.store( 0, std::memory_order_relaxed );
+        }
+    }else if( mPerSecond <= mCount.load( std::memory_order_relaxed ) ){
+        // window is already used up, don't contend on 'mCount'
+        mSuppressed.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+
+    if( mCount.fetch_add( 1, std::memory_order_relaxed ) < mPerSecond ){
+        suppressed = mSuppressed.exchange( 0, std::memory_order_relaxed );
+        return true;
+    }
+    mSuppressed.fetch_add( 1, std::memory_order_relaxed );
+    return false;
+}
+
+
+int64_t pt::log::RateLimiter::
+GetTimeMs_()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>( steady_clock::now().time_since_epoch() ).count();
+}
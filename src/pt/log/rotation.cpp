@@ -0,0 +1,156 @@
+#include "pt/log/rotation.h"
+
+#include "pt/alias.h"
+#include "pt/log/compress.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+using namespace pt::log;
+
+
+pt::log::RotationWorker::
+RotationWorker()
+{}
+
+
+pt::log::RotationWorker::
+~RotationWorker()
+{
+    {
+        pt::MutexLockGuard lock( mMutex );
+        mStopRequested = true;
+        mJobCondition.notify_one();
+    }
+    if( mThread.joinable() ){
+        mThread.join();
+    }
+}
+
+
+void pt::log::RotationWorker::
+Enqueue( const std::string& base_path, const std::string& rotated_path,
+         const RotationSettings& settings )
+{
+    Job job;
+    job.basePath    = base_path;
+    job.rotatedPath = rotated_path;
+    job.settings    = settings;
+
+    pt::MutexLockGuard lock( mMutex );
+    mJobs.push_back( std::move( job ) );
+    // the thread is started with the first rotation
+    if( !mThread.joinable() ){
+        mThread = std::thread( &RotationWorker::WorkerLoop_, this );
+    }
+    mJobCondition.notify_one();
+}
+
+
+void pt::log::RotationWorker::
+WaitIdle()
+{
+    pt::MutexLock lock( mMutex );
+    mIdleCondition.wait( lock, [this](){ return mJobs.empty() && !mBusy; } );
+}
+
+
+void pt::log::RotationWorker::
+WorkerLoop_()
+{
+    pt::MutexLock lock( mMutex );
+    for(;;){
+        mJobCondition.wait( lock, [this](){ return !mJobs.empty() || mStopRequested; } );
+        // pending jobs are finished even when stopping
+        if( mJobs.empty() ){
+            break;
+        }
+
+        Job job = std::move( mJobs.front() );
+        mJobs.pop_front();
+        mBusy = true;
+        lock.unlock();
+        Process_( job );
+        lock.lock();
+        mBusy = false;
+        mIdleCondition.notify_all();
+    }
+}
+
+
+void pt::log::RotationWorker::
+Process_( const Job& job )
+{
+    std::string final_path = job.rotatedPath;
+    if( job.settings.compress ){
+        std::string compressed_path = job.rotatedPath + CompressedFileExtension;
+        if( CompressFile( job.rotatedPath, compressed_path ) ){
+            std::remove( job.rotatedPath.c_str() );
+            final_path = compressed_path;
+        }else{
+            std::cout << "Failed to compress rotated log file '" << job.rotatedPath << "'\n";
+            std::remove( compressed_path.c_str() );
+        }
+    }
+
+    if( 0 == job.settings.maxRotatedFiles ){
+        return;
+    }
+    // the files on the disk, so the ones of earlier runs count too (oldest first)
+    //   newer files are still queued, their jobs apply the retention for them
+    auto files = FindRotatedFiles( job.basePath );
+    const std::string index = job.rotatedPath.substr( std::min( job.rotatedPath.length(), job.basePath.length() + 1 ) );
+    if( !index.empty() && (std::string::npos == index.find_first_not_of( "0123456789" )) ){
+        files.erase( files.upper_bound( std::stoull( index ) ), files.end() );
+    }
+    while( job.settings.maxRotatedFiles < files.size() ){
+        for( const auto& file : files.begin()->second ){
+            std::remove( file.c_str() );
+        }
+        files.erase( files.begin() );
+    }
+}
+
+
+std::map< uint64_t, std::vector<std::string> > pt::log::
+FindRotatedFiles( const std::string& base_path )
+{
+    namespace fs = std::filesystem;
+    std::map< uint64_t, std::vector<std::string> > files;
+    const fs::path    path( base_path );
+    const fs::path    directory = path.has_parent_path() ? path.parent_path() : fs::path( "." );
+    const std::string prefix    = path.filename().string() + ".";
+    const std::string extension = CompressedFileExtension;
+
+    std::error_code error;
+    for( fs::directory_iterator it( directory, error ), end; !error && (it != end); it.increment( error ) ){
+        const std::string name = it->path().filename().string();
+        if( (name.length() <= prefix.length()) || (0 != name.compare( 0, prefix.length(), prefix )) ){
+            continue;
+        }
+        std::string index = name.substr( prefix.length() );
+        if( (extension.length() < index.length())
+            && (0 == index.compare( index.length() - extension.length(), extension.length(), extension )) )
+        {
+            index.resize( index.length() - extension.length() );
+        }
+        if( index.empty() || (19 < index.length())
+            || (std::string::npos != index.find_first_not_of( "0123456789" )) )
+        {
+            continue;
+        }
+        files[std::stoull( index )].push_back( it->path().string() );
+    }
+    return files;
+}
+
+
+RotationWorker& pt::log::
+GetRotationWorker()
+{
+    static RotationWorker worker;
+    return worker;
+}
@@ -0,0 +1,80 @@
+#include "pt/log/sampler.h"
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <thread>
+
+using namespace pt::log;
+
+
+pt::log::CountSampler::
+CountSampler( uint32_t n ):
+    mRate( (0 < n) ? n : 1 ),
+    mCalls( 0 ),
+    mSkipped( 0 )
+{}
+
+
+pt::log::CountSampler::
+~CountSampler()
+{}
+
+
+bool pt::log::CountSampler::
+TryAcquire( uint64_t& skipped )
+{
+    skipped = 0;
+    if( 0 != mCalls.fetch_add( 1, std::memory_order_relaxed ) % mRate ){
+        mSkipped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+    skipped = mSkipped.exchange( 0, std::memory_order_relaxed );
+    return true;
+}
+
+
+pt::log::RandomSampler::
+RandomSampler( uint32_t n ):
+    mThreshold( (1 < n) ? std::numeric_limits<uint64_t>::max() / n
+                        : std::numeric_limits<uint64_t>::max() ),
+    mSkipped( 0 )
+{}
+
+
+pt::log::RandomSampler::
+~RandomSampler()
+{}
+
+
+bool pt::log::RandomSampler::
+TryAcquire( uint64_t& skipped )
+{
+    skipped = 0;
+    if( mThreshold < NextRandom_() ){
+        mSkipped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+    skipped = mSkipped.exchange( 0, std::memory_order_relaxed );
+    return true;
+}
+
+
+uint64_t pt::log::RandomSampler::
+NextRandom_()
+{
+    // xorshift64*, seeded once per thread (the state must never be 0)
+    thread_local uint64_t tlState = 0;
+    if( 0 == tlState ){
+        const uint64_t thread_hash = std::hash<std::thread::id>()( std::this_thread::get_id() );
+        const uint64_t time        = std::chrono::steady_clock::now().time_since_epoch().count();
+        tlState = ( thread_hash * 0x9E3779B97F4A7C15ull ) ^ time;
+        if( 0 == tlState ){
+            tlState = 0x9E3779B97F4A7C15ull;
+        }
+    }
+    tlState ^= tlState >> 12;
+    tlState ^= tlState << 25;
+    tlState ^= tlState >> 27;
+    return tlState * 0x2545F4914F6CDD1Dull;
+}
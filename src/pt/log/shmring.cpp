@@ -0,0 +1,499 @@
+#include "pt/log/shmring.h"
+
+#include "pt/def.h"
+#include "pt/utility.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifdef PT_PLATFORM_LINUX
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+using namespace pt::log;
+
+namespace{
+
+const uint32_t gMagic   = 0x50544c47;   // "PTLG"
+const uint32_t gVersion = 2;
+
+const uint32_t RecordEmpty      = 0;
+const uint32_t RecordCommitted  = 1;
+const uint32_t RecordPadding    = 2;
+const uint32_t RecordReserved   = 3;    // the length is known, the data is being copied
+
+// a record, that stays reserved but uncommitted for this long belongs to a dead producer
+const int64_t  gStallTimeoutMs  = 2000;
+
+// lives at the start of the segment, the record data follows it
+struct RingHeader{
+    std::atomic<uint32_t>   magic;              // written last during creation
+    uint32_t                version;
+    uint64_t                capacity;
+    std::atomic<int32_t>    daemonPid;
+    std::atomic<uint32_t>   dataSignal;         // futex word, incremented on every commit
+    std::atomic<uint32_t>   consumerWaiting;
+    std::atomic<int64_t>    heartbeatMs;
+    pthread_mutex_t         reserveMutex;       // process-shared and robust, guards 'writePos'
+    alignas(64) std::atomic<uint64_t> writePos; // reserved by producers
+    alignas(64) std::atomic<uint64_t> readPos;  // released by the consumer
+};
+
+// every record starts with this, records are 8-byte aligned
+struct RecordHeader{
+    std::atomic<uint32_t>   length;
+    std::atomic<uint32_t>   state;
+};
+
+const uint64_t gDataOffset = ( (sizeof(RingHeader) + 63) / 64 ) * 64;
+
+static_assert( sizeof(RecordHeader) == 8, "unexpected RecordHeader layout" );
+static_assert( 2 == ATOMIC_INT_LOCK_FREE,   "shared memory atomics have to be lock-free" );
+static_assert( 2 == ATOMIC_LLONG_LOCK_FREE, "shared memory atomics have to be lock-free" );
+
+
+inline uint64_t
+AlignUp8( uint64_t val )
+{
+    return ( val + 7 ) & ~uint64_t(7);
+}
+
+
+inline int64_t
+NowMs()
+{
+    // steady_clock is CLOCK_MONOTONIC on Linux, which is shared between processes
+    return std::chrono::duration_cast< std::chrono::milliseconds >(
+                std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+inline RingHeader*
+GetHeader( void* mapping )
+{
+    return reinterpret_cast<RingHeader*>( mapping );
+}
+
+
+// a committed record or padding can be consumed, an empty or reserved one has to be waited for
+inline bool
+IsConsumable( uint32_t state )
+{
+    return ( RecordCommitted == state ) || ( RecordPadding == state );
+}
+
+} //end of anonymous namespace
+
+
+pt::log::SharedMemoryRing::
+SharedMemoryRing()
+{}
+
+
+pt::log::SharedMemoryRing::
+~SharedMemoryRing()
+{
+    Close();
+}
+
+
+#ifdef PT_PLATFORM_LINUX
+
+static long
+FutexCall( std::atomic<uint32_t>* word, int op, uint32_t val, const struct timespec* timeout )
+{
+    // not FUTEX_PRIVATE, the word is shared between processes
+    return syscall( SYS_futex, reinterpret_cast<uint32_t*>( word ), op, val, timeout, nullptr, 0 );
+}
+
+
+bool pt::log::SharedMemoryRing::
+Create( const std::string& name, uint64_t capacity )
+{
+    Close();
+
+    uint64_t cap = 4096;
+    while( cap < capacity ){
+        cap <<= 1;
+    }
+
+    shm_unlink( name.c_str() ); // remove stale segment of a crashed daemon
+    int fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP );
+    if( fd < 0 ){
+        std::cout << "SharedMemoryRing: failed to create '" << name << "', errno(" << errno << ")\n";
+        return false;
+    }
+    if( 0 != ftruncate( fd, gDataOffset + cap ) ){
+        std::cout << "SharedMemoryRing: failed to resize '" << name << "', errno(" << errno << ")\n";
+        close( fd );
+        shm_unlink( name.c_str() );
+        return false;
+    }
+    bool mapped = Map_( fd, gDataOffset + cap );
+    close( fd );
+    if( !mapped ){
+        shm_unlink( name.c_str() );
+        return false;
+    }
+
+    RingHeader* h = new( mMapping ) RingHeader();
+    // robust: if a producer dies while holding it, the next one gets 'EOWNERDEAD' instead of a deadlock
+    //   error-checking: a crash handler interrupting 'TryWrite()' can't deadlock its own thread
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_setpshared( &attr, PTHREAD_PROCESS_SHARED );
+    pthread_mutexattr_setrobust( &attr, PTHREAD_MUTEX_ROBUST );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_ERRORCHECK );
+    const int mutex_result = pthread_mutex_init( &h->reserveMutex, &attr );
+    pthread_mutexattr_destroy( &attr );
+    if( 0 != mutex_result ){
+        std::cout << "SharedMemoryRing: failed to initialize the mutex of '" << name << "', error(" << mutex_result << ")\n";
+        Close();
+        shm_unlink( name.c_str() );
+        return false;
+    }
+    h->version  = gVersion;
+    h->capacity = cap;
+    h->daemonPid.store( getpid() );
+    h->dataSignal.store( 0 );
+    h->consumerWaiting.store( 0 );
+    h->heartbeatMs.store( NowMs() );
+    h->writePos.store( 0 );
+    h->readPos.store( 0 );
+    h->magic.store( gMagic, std::memory_order_release );
+
+    mName     = name;
+    mCapacity = cap;
+    mMask     = cap - 1;
+    mOwner    = true;
+    return true;
+}
+
+
+bool pt::log::SharedMemoryRing::
+Attach( const std::string& name, uint32_t timeout_ms )
+{
+    Close();
+
+    const int64_t deadline = NowMs() + timeout_ms;
+    do{
+        int fd = shm_open( name.c_str(), O_RDWR, 0 );
+        if( 0 <= fd ){
+            struct stat st;
+            bool ok = ( 0 == fstat( fd, &st ) )
+                   && ( gDataOffset < (uint64_t) st.st_size )
+                   && Map_( fd, st.st_size );
+            close( fd );
+
+            if( ok ){
+                RingHeader* h = GetHeader( mMapping );
+                ok = ( gMagic == h->magic.load( std::memory_order_acquire ) )
+                  && ( gVersion == h->version )
+                  && ( gDataOffset + h->capacity == mMappingSize );
+                if( ok ){
+                    mName     = name;
+                    mCapacity = h->capacity;
+                    mMask     = mCapacity - 1;
+                    mOwner    = false;
+                    if( IsConsumerAlive( timeout_ms ) ){
+                        return true;
+                    }
+                }
+                Close();
+            }
+        }
+        pt::SleepMS( 10 );
+    }while( NowMs() < deadline );
+
+    return false;
+}
+
+
+void pt::log::SharedMemoryRing::
+Close()
+{
+    if( nullptr != mMapping ){
+        munmap( mMapping, mMappingSize );
+        if( mOwner ){
+            shm_unlink( mName.c_str() );
+        }
+    }
+    mMapping     = nullptr;
+    mMappingSize = 0;
+    mData        = nullptr;
+    mCapacity    = 0;
+    mMask        = 0;
+    mOwner       = false;
+    mName.clear();
+}
+
+
+bool pt::log::SharedMemoryRing::
+TryWrite( const char* data, size_t length )
+{
+    if( !IsOpen() ){
+        return false;
+    }
+
+    RingHeader* h = GetHeader( mMapping );
+    const uint64_t size = AlignUp8( sizeof(RecordHeader) + length );
+    if( mCapacity / 4 < size ){
+        return false;
+    }
+
+    // reserve space (a record never wraps, the end of the ring is padded instead)
+    //   the headers are written before 'writePos' passes them, so the consumer always knows
+    //   the size of a reserved record and can skip it, if its producer dies before committing it
+    //   a producer dying inside the lock leaves nothing visible, as 'writePos' is stored last
+    if( !LockReservation_() ){
+        return false;
+    }
+    uint64_t pos = h->writePos.load( std::memory_order_relaxed );
+    const uint64_t read     = h->readPos.load( std::memory_order_acquire );
+    const uint64_t till_end = mCapacity - ( pos & mMask );
+    const uint64_t pad      = ( till_end < size ) ? till_end : 0;
+    if( mCapacity < pos + pad + size - read ){
+        pthread_mutex_unlock( &h->reserveMutex );
+        return false;
+    }
+    if( 0 < pad ){
+        RecordHeader* ph = reinterpret_cast<RecordHeader*>( mData + (pos & mMask) );
+        ph->length.store( pad - sizeof(RecordHeader), std::memory_order_relaxed );
+        ph->state.store( RecordPadding, std::memory_order_relaxed );
+    }
+    RecordHeader* rh = reinterpret_cast<RecordHeader*>( mData + ((pos + pad) & mMask) );
+    rh->length.store( length, std::memory_order_relaxed );
+    rh->state.store( RecordReserved, std::memory_order_relaxed );
+    h->writePos.store( pos + pad + size, std::memory_order_release );
+    pthread_mutex_unlock( &h->reserveMutex );
+
+    memcpy( reinterpret_cast<char*>( rh + 1 ), data, length );
+    rh->state.store( RecordCommitted, std::memory_order_release );
+    h->dataSignal.fetch_add( 1 );
+    return true;
+}
+
+
+void pt::log::SharedMemoryRing::
+Notify()
+{
+    if( !IsOpen() ){
+        return;
+    }
+    RingHeader* h = GetHeader( mMapping );
+    if( 0 != h->consumerWaiting.load() ){
+        FutexCall( &h->dataSignal, FUTEX_WAKE, 1, nullptr );
+    }
+}
+
+
+bool pt::log::SharedMemoryRing::
+IsConsumerAlive( uint32_t timeout_ms ) const
+{
+    if( !IsOpen() ){
+        return false;
+    }
+    RingHeader* h = GetHeader( mMapping );
+    if( int64_t(timeout_ms) < NowMs() - h->heartbeatMs.load() ){
+        return false;
+    }
+    pid_t pid = h->daemonPid.load();
+    return ( 0 < pid ) && ( 0 == kill( pid, 0 ) || EPERM == errno );
+}
+
+
+size_t pt::log::SharedMemoryRing::
+Consume( const RecordCallback& callback, size_t max_records )
+{
+    if( !IsOpen() ){
+        return 0;
+    }
+
+    RingHeader* h = GetHeader( mMapping );
+    size_t count = 0;
+    while( count < max_records ){
+        const uint64_t read = h->readPos.load( std::memory_order_relaxed );
+        if( read == h->writePos.load( std::memory_order_acquire ) ){
+            break;
+        }
+
+        RecordHeader*   rh     = reinterpret_cast<RecordHeader*>( mData + (read & mMask) );
+        uint32_t        state  = rh->state.load( std::memory_order_acquire );
+        uint32_t        length = rh->length.load( std::memory_order_relaxed );
+
+        if( RecordEmpty == state ){
+            // not possible below 'writePos', wait for the producer
+            break;
+        }
+        if( RecordReserved == state ){
+            // reserved, but not committed yet
+            //   if it stays like this, its producer died mid-write, skip it after the timeout
+            if( mStalledPos != read ){
+                mStalledPos     = read;
+                mStalledSinceMs = NowMs();
+                break;
+            }
+            if( NowMs() - mStalledSinceMs < gStallTimeoutMs ){
+                break;
+            }
+            std::cout << "SharedMemoryRing: skipping a record, that stayed uncommitted for "
+                      << gStallTimeoutMs << "ms (producer died?)\n";
+        }else if( RecordCommitted == state ){
+            callback( reinterpret_cast<const char*>( rh + 1 ), length );
+            ++count;
+        }
+
+        // zero the whole record, so stale bytes never look like a header in the next lap
+        const uint64_t size = AlignUp8( sizeof(RecordHeader) + length );
+        memset( reinterpret_cast<char*>( rh + 1 ), 0, size - sizeof(RecordHeader) );
+        rh->length.store( 0, std::memory_order_relaxed );
+        rh->state.store( RecordEmpty, std::memory_order_relaxed );
+        h->readPos.store( read + size, std::memory_order_release );
+        mStalledPos = UINT64_MAX;
+    }
+    return count;
+}
+
+
+void pt::log::SharedMemoryRing::
+Wait( uint32_t timeout_ms )
+{
+    if( !IsOpen() ){
+        return;
+    }
+
+    RingHeader* h = GetHeader( mMapping );
+    const uint32_t seen = h->dataSignal.load();
+    h->consumerWaiting.store( 1 );
+    // also sleeps, while the next record is reserved, but not committed yet
+    //   committing it increments 'dataSignal', a stalled record is skipped by 'Consume()' after the timeout
+    const uint64_t read = h->readPos.load();
+    const RecordHeader* rh = reinterpret_cast<const RecordHeader*>( mData + (read & mMask) );
+    if( ( read == h->writePos.load() ) || !IsConsumable( rh->state.load() ) ){
+        struct timespec ts;
+        ts.tv_sec  = timeout_ms / 1000;
+        ts.tv_nsec = ( timeout_ms % 1000 ) * 1000000;
+        FutexCall( &h->dataSignal, FUTEX_WAIT, seen, &ts );
+    }
+    h->consumerWaiting.store( 0 );
+}
+
+
+void pt::log::SharedMemoryRing::
+UpdateHeartbeat()
+{
+    if( !IsOpen() ){
+        return;
+    }
+    GetHeader( mMapping )->heartbeatMs.store( NowMs() );
+}
+
+
+bool pt::log::SharedMemoryRing::
+LockReservation_()
+{
+    RingHeader* h = GetHeader( mMapping );
+    int result = pthread_mutex_lock( &h->reserveMutex );
+    if( EOWNERDEAD == result ){
+        // the previous owner died, the guarded state is consistent at any point of the reservation
+        pthread_mutex_consistent( &h->reserveMutex );
+        result = 0;
+    }
+    return 0 == result;
+}
+
+
+bool pt::log::SharedMemoryRing::
+Map_( int fd, uint64_t size )
+{
+    void* addr = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if( MAP_FAILED == addr ){
+        std::cout << "SharedMemoryRing: mmap failed, errno(" << errno << ")\n";
+        return false;
+    }
+    mMapping     = addr;
+    mMappingSize = size;
+    mData        = reinterpret_cast<char*>( addr ) + gDataOffset;
+    return true;
+}
+
+
+#else
+
+bool pt::log::SharedMemoryRing::
+Create( const std::string& name, uint64_t capacity )
+{
+    return false;
+}
+
+bool pt::log::SharedMemoryRing::
+Attach( const std::string& name, uint32_t timeout_ms )
+{
+    return false;
+}
+
+void pt::log::SharedMemoryRing::
+Close()
+{}
+
+bool pt::log::SharedMemoryRing::
+TryWrite( const char* data, size_t length )
+{
+    return false;
+}
+
+void pt::log::SharedMemoryRing::
+Notify()
+{}
+
+bool pt::log::SharedMemoryRing::
+IsConsumerAlive( uint32_t timeout_ms ) const
+{
+    return false;
+}
+
+size_t pt::log::SharedMemoryRing::
+Consume( const RecordCallback& callback, size_t max_records )
+{
+    return 0;
+}
+
+void pt::log::SharedMemoryRing::
+Wait( uint32_t timeout_ms )
+{}
+
+void pt::log::SharedMemoryRing::
+UpdateHeartbeat()
+{}
+
+bool pt::log::SharedMemoryRing::
+LockReservation_()
+{
+    return false;
+}
+
+bool pt::log::SharedMemoryRing::
+Map_( int fd, uint64_t size )
+{
+    return false;
+}
+
+#endif
+
+
+bool pt::log::SharedMemoryRing::
+IsOpen() const
+{
+    return nullptr != mMapping;
+}
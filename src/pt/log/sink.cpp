@@ -0,0 +1,196 @@
+#include "pt/log/sink.h"
+
+#include "pt/alias.h"
+#include "pt/log/logstream.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+using namespace pt::log;
+
+static std::atomic<bool> gLineTimestamps( true );
+
+
+void pt::log::
+AppendLineHeader( const LogRecord& record, std::string& out )
+{
+    // carries its own time and prefix
+    if( RecordType::Json == record.type ){
+        return;
+    }
+    if( gLineTimestamps.load( std::memory_order_relaxed ) ){
+        thread_local TimestampFormatter tlFormatter;
+        char timestamp[TimestampFormatter::Length];
+        tlFormatter.Format( record.timestamp, timestamp );
+        out.append( timestamp, sizeof(timestamp) );
+        out.push_back( ' ' );
+    }
+
+    const std::string& prefix = record.stream->getPrefix();
+    if( 0 < prefix.length() ){
+        out.append( prefix );
+        out.append( ": ", 2 );
+    }
+}
+
+
+void pt::log::
+SetLineTimestamps( bool enabled )
+{
+    gLineTimestamps = enabled;
+}
+
+
+pt::log::Sink::
+Sink()
+{}
+
+
+pt::log::Sink::
+~Sink()
+{}
+
+
+void pt::log::Sink::
+Flush()
+{}
+
+
+//--------------------------------------------------
+
+
+pt::log::ConsoleSink::
+ConsoleSink()
+{}
+
+
+pt::log::ConsoleSink::
+~ConsoleSink()
+{}
+
+
+void pt::log::ConsoleSink::
+Write( const LogRecord& record )
+{
+    std::cout << record.text;
+}
+
+
+void pt::log::ConsoleSink::
+Flush()
+{
+    std::cout.flush();
+}
+
+
+//--------------------------------------------------
+
+
+pt::log::NullSink::
+NullSink()
+{}
+
+
+pt::log::NullSink::
+~NullSink()
+{}
+
+
+void pt::log::NullSink::
+Write( const LogRecord& record )
+{}
+
+
+//--------------------------------------------------
+
+
+pt::log::MemorySink::
+MemorySink( size_t capacity ):
+    mBuffer( std::max<size_t>( capacity, 1 ) )
+{}
+
+
+pt::log::MemorySink::
+~MemorySink()
+{}
+
+
+void pt::log::MemorySink::
+Write( const LogRecord& record )
+{
+    pt::MutexLockGuard lock( mMutex );
+    mHeaderScratch.clear();
+    AppendLineHeader( record, mHeaderScratch );
+    Append_( mHeaderScratch.data(), mHeaderScratch.length() );
+    Append_( record.text.data(), record.text.length() );
+}
+
+
+std::string pt::log::MemorySink::
+GetContents() const
+{
+    pt::MutexLockGuard lock( mMutex );
+    if( !mWrapped ){
+        return std::string( mBuffer.data(), mWritePos );
+    }
+
+    std::string contents;
+    contents.reserve( mBuffer.size() );
+    contents.append( mBuffer.data() + mWritePos, mBuffer.size() - mWritePos );
+    contents.append( mBuffer.data(), mWritePos );
+
+    // the oldest line is partially overwritten
+    size_t line_end = contents.find( '\n' );
+    if( std::string::npos != line_end ){
+        contents.erase( 0, line_end+1 );
+    }
+    return contents;
+}
+
+
+void pt::log::MemorySink::
+Dump( std::ostream& os ) const
+{
+    os << GetContents();
+    os.flush();
+}
+
+
+void pt::log::MemorySink::
+Clear()
+{
+    pt::MutexLockGuard lock( mMutex );
+    mWritePos = 0;
+    mWrapped  = false;
+}
+
+
+size_t pt::log::MemorySink::
+GetCapacity() const
+{
+    return mBuffer.size();
+}
+
+
+void pt::log::MemorySink::
+Append_( const char* data, size_t length )
+{
+    const size_t capacity = mBuffer.size();
+    // only the end of an oversized record fits
+    if( capacity < length ){
+        data  += length - capacity;
+        length = capacity;
+    }
+
+    const size_t first_part = std::min( length, capacity - mWritePos );
+    memcpy( mBuffer.data() + mWritePos, data, first_part );
+    memcpy( mBuffer.data(), data + first_part, length - first_part );
+
+    mWritePos += length;
+    if( capacity <= mWritePos ){
+        mWritePos -= capacity;
+        mWrapped = true;
+    }
+}
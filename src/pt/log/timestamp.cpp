@@ -0,0 +1,69 @@
+#include "pt/log/timestamp.h"
+
+#include "pt/def.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace pt::log;
+
+static const int64_t gNanosecondsPerSecond      = 1000000000;
+static const int64_t gNanosecondsPerMillisecond = 1000000;
+// length of "YYYY-MM-DD HH:MM:SS."
+static const size_t  gCachedLength = TimestampFormatter::Length - 3;
+
+
+int64_t pt::log::
+GetTimestamp()
+{
+    #ifdef PT_PLATFORM_LINUX
+    struct timespec now;
+    if( 0 == clock_gettime( CLOCK_REALTIME_COARSE, &now ) ){
+        return int64_t( now.tv_sec ) * gNanosecondsPerSecond + now.tv_nsec;
+    }
+    #endif
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>( system_clock::now().time_since_epoch() ).count();
+}
+
+
+void pt::log::TimestampFormatter::
+Format( int64_t timestamp, char* out )
+{
+    int64_t second      = timestamp / gNanosecondsPerSecond;
+    int64_t millisecond = ( timestamp % gNanosecondsPerSecond ) / gNanosecondsPerMillisecond;
+    if( millisecond < 0 ){
+        second      -= 1;
+        millisecond += 1000;
+    }
+    if( second != mCachedSecond ){
+        UpdateCache_( second );
+    }
+
+    memcpy( out, mCache, gCachedLength );
+    out[gCachedLength]   = char( '0' + millisecond / 100 );
+    out[gCachedLength+1] = char( '0' + (millisecond / 10) % 10 );
+    out[gCachedLength+2] = char( '0' + millisecond % 10 );
+}
+
+
+void pt::log::TimestampFormatter::
+UpdateCache_( int64_t second )
+{
+    std::time_t time = static_cast<std::time_t>( second );
+    struct tm   local;
+    #ifdef PT_PLATFORM_WINDOWS
+    localtime_s( &local, &time );
+    #else
+    localtime_r( &time, &local );
+    #endif
+
+    char buffer[64];
+    snprintf( buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d.",
+              local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+              local.tm_hour, local.tm_min, local.tm_sec );
+    memcpy( mCache, buffer, gCachedLength );
+    mCachedSecond = second;
+}
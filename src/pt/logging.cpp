@@ -1,11 +1,17 @@
 #include "pt/logging.h"
 
+#include "pt/alias.h"
+#include "pt/log/backend.h"
+#include "pt/log/category.h"
+#include "pt/log/crashhandler.h"
 #include "pt/def.h"
 #include "pt/utility.hpp"
 
 #ifdef PT_PLATFORM_LINUX
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <signal.h>
+#include <cerrno>
 
 #elif defined PT_PLATFORM_WINDOWS
 #include <windows.h>
@@ -46,21 +52,29 @@
 
 
 #include <chrono>
+#include <fstream>
 #include <iomanip>
 #include <algorithm>
+#include <mutex>
 
 
 
 
 //initializing externs
-pt::log::logstream pt::log::debug{ "Debug" };
-pt::log::logstream pt::log::out{ "Log" };
-pt::log::logstream pt::log::warn{ "Warning" };
-pt::log::logstream pt::log::err{ "ERROR" };
+//  under overload, request threads keep their latency at the expense of debug and info output
+pt::log::logstream pt::log::debug{ "Debug",   PT_LOG_LEVEL_DEBUG, pt::log::OverflowPolicy::DropNewest };
+pt::log::logstream pt::log::out{   "Log",     PT_LOG_LEVEL_INFO,  pt::log::OverflowPolicy::DropNewest };
+pt::log::logstream pt::log::warn{  "Warning", PT_LOG_LEVEL_WARN,  pt::log::OverflowPolicy::Block };
+pt::log::logstream pt::log::err{   "ERROR",   PT_LOG_LEVEL_ERR,   pt::log::OverflowPolicy::Block };   // never drops
 
 
 std::string gRootDirectory;
 std::string gFilePath;
+pt::log::BackendSettings gBackendSettings;
+bool gCrashHandlerEnabled = true;
+
+std::mutex  gSettingsMutex;
+std::string gSettingsFile;
 
 
 std::string pt::log::
@@ -118,8 +132,7 @@ InitializeLinux(const std::string& root_directory,
         return false;
     }
 
-
-    //TODO: initialize multiprocess structure
+    //the multiprocess structure (logger daemon connection) is set up by the backend
     EnsureExistingDirectory(filename);
 
     LoadSettings();
@@ -209,6 +222,13 @@ Initialize(const std::string &root_directory,
     gRootDirectory = root_directory;
     gFilePath = fullpath;
 
+    gBackendSettings.daemonTimeoutMs = timeout;
+    if( !GetBackend().Start( fullpath, gBackendSettings ) ){
+        return false;
+    }
+    if( gCrashHandlerEnabled ){
+        InstallCrashHandler();
+    }
     return true;
 }
 
@@ -216,18 +236,271 @@ Initialize(const std::string &root_directory,
 void pt::log::
 Destroy()
 {
-    //TODO: implement
+    UninstallCrashHandler();
+    GetBackend().Stop();
+}
+
+static bool
+ParseSwitch( const std::string& value, bool& result )
+{
+    const std::string lower = pt::StringToLower( value );
+    if( ("on" == lower) || ("true" == lower) || ("1" == lower) ){
+        result = true;
+    }else if( ("off" == lower) || ("false" == lower) || ("0" == lower) ){
+        result = false;
+    }else{
+        return false;
+    }
+    return true;
 }
 
+
+static pt::log::logstream*
+FindStream( const std::string& name )
+{
+    if( "debug" == name ){  return &pt::log::debug; }
+    if( "out" == name ){    return &pt::log::out; }
+    if( "warn" == name ){   return &pt::log::warn; }
+    if( "err" == name ){    return &pt::log::err; }
+    return nullptr;
+}
+
+
+static bool
+ApplySetting( const std::string& key, bool enabled )
+{
+    const std::string stream_prefix   = "stream.";
+    const std::string category_prefix = "category.";
+    if( 0 == key.compare( 0, stream_prefix.length(), stream_prefix ) ){
+        logstream* stream = FindStream( key.substr( stream_prefix.length() ) );
+        if( nullptr == stream ){
+            return false;
+        }
+        stream->setEnabled( enabled );
+        return true;
+    }
+    if( 0 == key.compare( 0, category_prefix.length(), category_prefix ) ){
+        const std::string name = key.substr( category_prefix.length() );
+        if( name.empty() ){
+            return false;
+        }
+        if( "*" == name ){
+            Category::SetAllEnabled( enabled );
+        }else{
+            SetCategoryEnabled( pt::Name( name ), enabled );
+        }
+        return true;
+    }
+    return false;
+}
+
+
+// runs on the writer thread too (see 'SetSettingsReloadSignal()'), so problems go to std::cout instead of the log
 void pt::log::
 LoadSettings()
 {
-    //TODO: temp solution, replace
-    //noexcept?
-    pt::log::debug.setEnabled(true);
-    pt::log::out.setEnabled(true);
-    pt::log::warn.setEnabled(true);
-    pt::log::err.setEnabled(true);
+    std::string path;
+    {
+        pt::MutexLockGuard lock( gSettingsMutex );
+        path = gSettingsFile;
+    }
+    if( path.empty() ){
+        return;
+    }
+
+    std::ifstream file( path );
+    if( !file.is_open() ){
+        std::cout << "Failed to open log settings file '" << path << "'\n";
+        return;
+    }
+
+    std::string line;
+    size_t      line_number = 0;
+    while( std::getline( file, line ) ){
+        ++line_number;
+        const size_t comment = line.find( '#' );
+        if( std::string::npos != comment ){
+            line.erase( comment );
+        }
+        line = pt::TrimWhitespaces( line );
+        if( line.empty() ){
+            continue;
+        }
+
+        std::string parts[2];
+        bool        enabled = false;
+        if( !pt::SplitString( parts, line, "=" )
+            || !ParseSwitch( pt::TrimWhitespaces( parts[1] ), enabled )
+            || !ApplySetting( pt::TrimWhitespaces( parts[0] ), enabled ) )
+        {
+            std::cout << "Invalid log setting in '" << path << "' line " << line_number << ": '" << line << "'\n";
+        }
+    }
+}
+
+
+void pt::log::
+SetSettingsFile( const std::string& path )
+{
+    pt::MutexLockGuard lock( gSettingsMutex );
+    gSettingsFile = path;
+}
+
+
+#ifdef PT_PLATFORM_LINUX
+static void
+HandleReloadSignal( int signal )
+{
+    Backend::RequestSettingsReload();
+}
+#endif
+
+
+bool pt::log::
+SetSettingsReloadSignal( int signal )
+{
+#ifdef PT_PLATFORM_LINUX
+    struct sigaction action;
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = HandleReloadSignal;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset( &action.sa_mask );
+    if( 0 != sigaction( signal, &action, nullptr ) ){
+        std::cout << "Failed to set the log settings reload signal " << signal << ", errno(" << errno << ")\n";
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void pt::log::
+SetQueueCapacity( size_t records )
+{
+    gBackendSettings.queueCapacity = records;
+}
+
+
+void pt::log::
+SetFileBufferSize( size_t bytes )
+{
+    gBackendSettings.fileBufferSize = bytes;
+}
+
+
+void pt::log::
+SetFlushInterval( uint32_t milliseconds )
+{
+    gBackendSettings.flushIntervalMs = milliseconds;
+}
+
+
+void pt::log::
+SetFlushOnSend( bool enabled )
+{
+    gBackendSettings.flushOnSend = enabled;
+}
+
+
+void pt::log::
+SetRotation( const RotationSettings& settings )
+{
+    gBackendSettings.rotation = settings;
+}
+
+
+void pt::log::
+SetFileMode( FileMode mode )
+{
+    gBackendSettings.fileMode = mode;
+}
+
+
+void pt::log::
+SetTimestamps( bool enabled )
+{
+    SetLineTimestamps( enabled );
+}
+
+
+void pt::log::
+SetCrashHandler( bool enabled )
+{
+    gCrashHandlerEnabled = enabled;
+}
+
+
+void pt::log::
+SetOverflowSeverity( uint8_t level )
+{
+    gBackendSettings.overflowSeverity = level;
+}
+
+
+void pt::log::
+SetDropReportInterval( uint32_t milliseconds )
+{
+    gBackendSettings.dropReportIntervalMs = milliseconds;
+}
+
+
+void pt::log::
+SetDaemonName( const std::string& shm_name )
+{
+    gBackendSettings.daemonName = shm_name;
+}
+
+
+bool pt::log::
+IsConnectedToDaemon()
+{
+    return GetBackend().IsConnectedToDaemon();
+}
+
+
+bool pt::log::
+RegisterSink( const std::string& name, std::shared_ptr<Sink> sink )
+{
+    return GetBackend().RegisterSink( name, std::move( sink ) );
+}
+
+
+std::shared_ptr<Sink> pt::log::
+GetSink( const std::string& name )
+{
+    return GetBackend().FindSink( name );
+}
+
+
+bool pt::log::
+BindSinks( const logstream& stream, const std::vector<std::string>& sink_names )
+{
+    SinkList sinks;
+    for( const auto& name : sink_names ){
+        auto sink = GetBackend().FindSink( name );
+        if( nullptr == sink ){
+            return false;
+        }
+        sinks.push_back( sink );
+    }
+    GetBackend().BindSinks( stream, sinks );
+    return true;
+}
+
+
+void pt::log::
+BindSinks( const logstream& stream, const SinkList& sinks )
+{
+    GetBackend().BindSinks( stream, sinks );
+}
+
+
+void pt::log::
+ResetSinks( const logstream& stream )
+{
+    GetBackend().ResetSinks( stream );
 }
 
 
@@ -1,83 +1,293 @@
 #include "pt/name.h"
 
 #include "pt/alias.h"
-#include "pt/utility.hpp"
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
 
-uint64_t    pt::Name::smNextFreeID = 1;
-std::mutex  pt::Name::smMutex;
-std::unordered_map<      uint64_t, pt::Name::ConstNameDataPtr > pt::Name::smMapById   = std::unordered_map<      uint64_t, Name::ConstNameDataPtr >();
-std::unordered_multimap< uint32_t, pt::Name::ConstNameDataPtr > pt::Name::smMapByHash = std::unordered_multimap< uint32_t, Name::ConstNameDataPtr >();
 
+// the characters ('length' + '\0') are stored right after the entry, in the same arena
+struct pt::NameEntry{
+    uint64_t                                id;
+    uint32_t                                hash;
+    uint32_t                                length;
+    const NameEntry*                        next;           // next entry of the same hash bucket
+    mutable std::atomic<const std::string*> stdString;      // created by the first 'GetStdString()'
 
-pt::Name::
-Name()
-{}
+    const char* GetChars() const{
+        return reinterpret_cast<const char*>( this + 1 );
+    }
+};
 
 
-pt::Name::
-Name( const Name& other ):
-    mData( other.mData ), mId( other.mId )
-{}
+namespace{
 
+using pt::NameEntry;
 
-pt::Name::
-Name( Name&& source ):
-    mData( std::move(source.mData) ), mId( source.mId )
+// append-only storage of the entries, never freed
+//   not thread-safe, every shard has its own
+class NameArena
 {
-    source.mData = nullptr;
-    source.mId   = 0;
+public:
+    static const size_t BlockSize = 1024*1024;
+
+    void* Allocate( size_t size ){
+        size = ( size + alignof(NameEntry) - 1 ) & ~( alignof(NameEntry) - 1 );
+        if( BlockSize / 4 < size ){
+            // large strings get their own block, so the current one is not wasted
+            return AllocateBlock( size );
+        }
+        if( mRemaining < size ){
+            mCurrent   = static_cast<char*>( AllocateBlock( BlockSize ) );
+            mRemaining = BlockSize;
+        }
+        void* retval = mCurrent;
+        mCurrent   += size;
+        mRemaining -= size;
+        return retval;
+    }
+
+private:
+    static void* AllocateBlock( size_t size ){
+        void* block = malloc( size );
+        if( nullptr == block ){
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+
+    char*   mCurrent    = nullptr;
+    size_t  mRemaining  = 0;
+};
+
+
+// a part of the table of unique strings, selected by the high bits of the hash
+//   chained hash table, the entries are linked by 'NameEntry::next'
+struct alignas(64) NameShard{
+    std::mutex                      mutex;
+    std::vector<const NameEntry*>   buckets;    // size is 0 or a power of 2
+    size_t                          count = 0;
+    NameArena                       arena;
+};
+
+
+class NameTable
+{
+public:
+    static const uint32_t   ShardBits   = 6;
+    static const size_t     ShardCount  = size_t( 1 ) << ShardBits;
+    // id -> entry lookup through a directory of chunk groups, groups and chunks are allocated on demand
+    //   ids fit into 32 bits, the directory itself stays small (8KB)
+    static const uint32_t   IdChunkBits = 14;
+    static const size_t     IdChunkSize = size_t( 1 ) << IdChunkBits;
+    static const uint32_t   IdGroupBits = 8;
+    static const size_t     IdGroupSize = size_t( 1 ) << IdGroupBits;
+    static const size_t     MaxIdGroups = size_t( 1 ) << ( 32 - IdChunkBits - IdGroupBits );
+
+    const NameEntry* Intern( const char* str, uint32_t length, uint32_t hash );
+    const NameEntry* Find( const char* str, uint32_t length, uint32_t hash );
+    const NameEntry* FindById( uint64_t id ) const;
+
+private:
+    using IdChunk = std::atomic<const NameEntry*>;
+    using IdGroup = std::atomic<IdChunk*>;
+
+    static const NameEntry* FindInShard_( const NameShard& shard, const char* str, uint32_t length, uint32_t hash );
+    static void             Rehash_( NameShard& shard );
+    void                    RegisterId_( const NameEntry* entry );
+
+    NameShard               mShards[ShardCount];
+    std::atomic<uint64_t>   mNextFreeId{ 1 };   // 0: non-existent | 1+: valid ID
+    std::mutex              mIdChunkMutex;
+    std::atomic<IdGroup*>   mIdGroups[MaxIdGroups];     // zeroed by the value-initialization in 'GetNameTable()'
+};
+
+
+// created at the first use and never destroyed, so names can be used during static initialization
+//   and by the destructors of other static objects too
+NameTable&
+GetNameTable()
+{
+    alignas(NameTable) static char storage[sizeof(NameTable)];
+    static NameTable* table = new( storage ) NameTable();
+    return *table;
 }
 
 
-pt::Name::
-Name( char* const cstr )
+const NameEntry* NameTable::
+FindInShard_( const NameShard& shard, const char* str, uint32_t length, uint32_t hash )
 {
-    CreatePreInitState_( cstr );
+    if( shard.buckets.empty() ){
+        return nullptr;
+    }
+    const NameEntry* entry = shard.buckets[hash & ( shard.buckets.size() - 1 )];
+    for( ; nullptr != entry; entry = entry->next ){
+        if( ( hash == entry->hash ) && ( length == entry->length )
+            && ( 0 == memcmp( str, entry->GetChars(), length ) ) )
+        {
+            return entry;
+        }
+    }
+    return nullptr;
 }
 
 
-pt::Name::
-Name( const char* const cstr )
+void NameTable::
+Rehash_( NameShard& shard )
 {
-    CreatePreInitState_( cstr );
+    std::vector<const NameEntry*> buckets( std::max<size_t>( 16, shard.buckets.size() * 2 ), nullptr );
+    const size_t mask = buckets.size() - 1;
+    for( const NameEntry* head : shard.buckets ){
+        while( nullptr != head ){
+            NameEntry* entry = const_cast<NameEntry*>( head );
+            head = entry->next;
+            entry->next = buckets[entry->hash & mask];
+            buckets[entry->hash & mask] = entry;
+        }
+    }
+    shard.buckets.swap( buckets );
 }
 
 
+void NameTable::
+RegisterId_( const NameEntry* entry )
+{
+    const uint64_t chunk_index = entry->id >> IdChunkBits;
+    const uint64_t group_index = chunk_index >> IdGroupBits;
+    if( MaxIdGroups <= group_index ){
+        assert( false && "pt::Name: out of ids" );
+        return;
+    }
+    IdGroup* group = mIdGroups[group_index].load( std::memory_order_acquire );
+    IdChunk* chunk = ( nullptr != group ) ? group[chunk_index & ( IdGroupSize - 1 )].load( std::memory_order_acquire )
+                                          : nullptr;
+    if( nullptr == chunk ){
+        pt::MutexLockGuard lock( mIdChunkMutex );
+        group = mIdGroups[group_index].load( std::memory_order_acquire );
+        if( nullptr == group ){
+            group = new IdGroup[IdGroupSize];
+            for( size_t i=0; i<IdGroupSize; ++i ){
+                group[i].store( nullptr, std::memory_order_relaxed );
+            }
+            mIdGroups[group_index].store( group, std::memory_order_release );
+        }
+        chunk = group[chunk_index & ( IdGroupSize - 1 )].load( std::memory_order_acquire );
+        if( nullptr == chunk ){
+            chunk = new IdChunk[IdChunkSize];
+            for( size_t i=0; i<IdChunkSize; ++i ){
+                chunk[i].store( nullptr, std::memory_order_relaxed );
+            }
+            group[chunk_index & ( IdGroupSize - 1 )].store( chunk, std::memory_order_release );
+        }
+    }
+    chunk[entry->id & ( IdChunkSize - 1 )].store( entry, std::memory_order_release );
+}
+
+
+const NameEntry* NameTable::
+Intern( const char* str, uint32_t length, uint32_t hash )
+{
+    NameShard& shard = mShards[hash >> ( 32 - ShardBits )];
+    pt::MutexLockGuard lock( shard.mutex );
+    const NameEntry* found = FindInShard_( shard, str, length, hash );
+    if( nullptr != found ){
+        return found;
+    }
+
+    // if 'str' was not found, create a new element
+    if( shard.buckets.size() <= shard.count ){
+        Rehash_( shard );
+    }
+    void* storage = shard.arena.Allocate( sizeof(NameEntry) + length + 1 );
+    NameEntry* entry = new( storage ) NameEntry;
+    entry->id       = mNextFreeId.fetch_add( 1, std::memory_order_relaxed );
+    entry->hash     = hash;
+    entry->length   = length;
+    entry->stdString.store( nullptr, std::memory_order_relaxed );
+    char* chars = reinterpret_cast<char*>( entry + 1 );
+    memcpy( chars, str, length );
+    chars[length] = '\0';
+
+    const size_t bucket = hash & ( shard.buckets.size() - 1 );
+    entry->next = shard.buckets[bucket];
+    shard.buckets[bucket] = entry;
+    ++shard.count;
+
+    // the shard stays locked, until the id is registered too, so that
+    //  'FindById()' finds every id that an instance can have
+    RegisterId_( entry );
+    return entry;
+}
+
+
+const NameEntry* NameTable::
+Find( const char* str, uint32_t length, uint32_t hash )
+{
+    NameShard& shard = mShards[hash >> ( 32 - ShardBits )];
+    pt::MutexLockGuard lock( shard.mutex );
+    return FindInShard_( shard, str, length, hash );
+}
+
+
+const NameEntry* NameTable::
+FindById( uint64_t id ) const
+{
+    const uint64_t chunk_index = id >> IdChunkBits;
+    const uint64_t group_index = chunk_index >> IdGroupBits;
+    if( MaxIdGroups <= group_index ){
+        return nullptr;
+    }
+    const IdGroup* group = mIdGroups[group_index].load( std::memory_order_acquire );
+    if( nullptr == group ){
+        return nullptr;
+    }
+    const IdChunk* chunk = group[chunk_index & ( IdGroupSize - 1 )].load( std::memory_order_acquire );
+    if( nullptr == chunk ){
+        return nullptr;
+    }
+    return chunk[id & ( IdChunkSize - 1 )].load( std::memory_order_acquire );
+}
+
+} //end of anonymous namespace
+
+
 pt::Name::
-Name( const std::string& str )
+Name( char* const cstr )
 {
-    CreatePreInitState_( str.c_str() );
+    if( nullptr != cstr ){
+        Intern_( cstr, strlen( cstr ) );
+    }
 }
 
 
 pt::Name::
-~Name()
-{}
+Name( const char* const cstr )
+{
+    if( nullptr != cstr ){
+        Intern_( cstr, strlen( cstr ) );
+    }
+}
 
 
-pt::Name& pt::Name::
-operator=( const Name& other )
+pt::Name::
+Name( const std::string& str )
 {
-    mData = other.mData;
-    mId   = other.mId;
-    return *this;
+    Intern_( str.data(), str.length() );
 }
 
 
-pt::Name& pt::Name::
-operator=( Name&& source )
+pt::Name::
+Name( const NameLiteral& literal )
 {
-    if( this != &source ){
-        mData = std::move(source.mData);
-        mId = source.mId;
-        source.mData = nullptr;
-        source.mId = 0;
+    if( nullptr != literal.c_str() ){
+        Intern_( literal.c_str(), literal.length(), literal.GetHash() );
     }
-    return *this;
 }
 
 
@@ -92,10 +302,6 @@ operator=( const std::string& str )
 bool pt::Name::
 operator==( const Name& other ) const
 {
-    // sync instances globally, if needed
-    this->Init_();
-    other.Init_();
-
     if( (0 == mId) || (0 == other.mId) ){
         return false;
     }
@@ -111,138 +317,179 @@ operator!=( const Name& other ) const
 }
 
 
+bool pt::Name::
+operator<( const Name& other ) const
+{
+    return ( mId < other.mId );
+}
+
+
 size_t pt::Name::
 length() const
 {
-    return GetStdString().length();
+    const NameEntry* entry = GetEntry_();
+    return ( nullptr != entry ) ? entry->length : 0;
 }
 
 
 const std::string& pt::Name::
 GetStdString() const
 {
-    Init_();
-    assert( UINT64_MAX != mId );
-    if( 0 == mId ){
+    const NameEntry* entry = GetEntry_();
+    if( nullptr == entry ){
         static const std::string DummyEmptyString;
         return DummyEmptyString;
     }
-    assert( nullptr != mData );
-    return mData->str;
+    const std::string* str = entry->stdString.load( std::memory_order_acquire );
+    if( nullptr == str ){
+        // the copy lives as long as the entry (forever), the slower thread discards its own
+        const std::string* created = new std::string( entry->GetChars(), entry->length );
+        if( entry->stdString.compare_exchange_strong( str, created, std::memory_order_acq_rel, std::memory_order_acquire ) ){
+            str = created;
+        }else{
+            delete created;
+        }
+    }
+    return *str;
+}
+
+
+const char* pt::Name::
+c_str() const
+{
+    const NameEntry* entry = GetEntry_();
+    return ( nullptr != entry ) ? entry->GetChars() : "";
+}
+
+
+std::string_view pt::Name::
+GetStringView() const
+{
+    const NameEntry* entry = GetEntry_();
+    return ( nullptr != entry ) ? std::string_view( entry->GetChars(), entry->length ) : std::string_view();
 }
 
 
 bool pt::Name::
 IsEmpty() const
 {
-    // check, that mId is not out of sync with mData
-    assert( ((0 == mId) && (nullptr == mData)) || ((0 != mId) && (nullptr != mData)) );
-    return (0 == mId) || ( IsInPreInitState_() && 0 == mData->str.length() );
+#ifndef PT_NAME_COMPACT
+    // check, that mId is not out of sync with mEntry
+    assert( ((0 == mId) && (nullptr == mEntry)) || ((0 != mId) && (nullptr != mEntry)) );
+#endif
+    return (0 == mId);
 }
 
 
 void pt::Name::
 Init() const
+{}
+
+
+uint64_t pt::Name::
+GetId() const
 {
-    Init_();
+    return mId;
 }
 
 
-void pt::Name::
-CreateSyncedState_( const char* const cstr, size_t length ) const
+uint32_t pt::Name::
+GetHash() const
 {
-    assert( nullptr != cstr );
-    size_t    strlength = ( 0 < length ) ? length : strlen( cstr );
-    uint32_t  hash = pt::MurmurHash2( cstr, strlength, smHashSeed );
-    ConstNameDataPtr data;
-
-    //data should already be sanitized here
-    // if new data is empty string
-    if( 0 == strlength ){
-        mData = nullptr;
-        mId   = 0;
-        return;
-    }
+    const NameEntry* entry = GetEntry_();
+    return ( nullptr != entry ) ? entry->hash : 0;
+}
 
-    pt::MutexLockGuard lock( smMutex );
-    auto range = smMapByHash.equal_range( hash );
-    for( auto iter = range.first; iter!= range.second; ++iter ){
-        ConstNameDataPtr pNameData = iter->second;
-        // if string values match
-        if( 0 == strcmp( cstr, pNameData->str.c_str() ) ){
-            mData = pNameData;
-            mId = pNameData->id;
-            return;
-        }
-    }
 
-    // if 'cstr' was not found, create a new element
-    uint64_t newid = Name::TakeNextFreeId_NoLock();
-    mData = std::make_shared< const NameData >( std::string( cstr ), newid );
-    mId = newid;
-    smMapByHash.insert( std::make_pair( hash, mData ) );
-    smMapById.insert( std::make_pair( newid, mData ) );
+pt::Name pt::Name::
+FindById( uint64_t id )
+{
+    Name retval;
+    retval.Assign_( GetNameTable().FindById( id ) );
+    return retval;
 }
 
 
-bool pt::Name::
-IsInPreInitState_() const
+pt::Name pt::Name::
+Find( std::string_view str )
 {
-    return ( UINT64_MAX == mId );
+    Name retval;
+    if( !str.empty() && ( str.length() <= UINT32_MAX ) ){
+        retval.Assign_( GetNameTable().Find( str.data(), static_cast<uint32_t>( str.length() ),
+                                             pt::HashName( str.data(), str.length() ) ) );
+    }
+    return retval;
 }
 
 
-uint64_t pt::Name::
-TakeNextFreeId()
+pt::Name pt::Name::
+Intern( std::string_view str )
 {
-    pt::MutexLockGuard lock( smMutex );
-    return TakeNextFreeId_NoLock();
+    Name retval;
+    retval.Intern_( str.data(), str.length() );
+    return retval;
 }
 
 
-uint64_t pt::Name::
-TakeNextFreeId_NoLock()
+void pt::Name::
+Intern_( const char* str, size_t length )
 {
-    uint64_t retval = smNextFreeID;
-    ++smNextFreeID;
-    return retval;
+    Intern_( str, length, pt::HashName( str, length ) );
 }
 
 
 void pt::Name::
-CreatePreInitState_( const char* const cstr )
+Intern_( const char* str, size_t length, uint32_t hash )
 {
-    if( nullptr == cstr ){
-        mData = nullptr;
-        mId = 0;
-        return;
-    }
-    if( 0 == strlen( cstr ) ){
-        mData = nullptr;
-        mId = 0;
+    // if new data is empty string
+    if( 0 == length ){
+        Assign_( nullptr );
         return;
     }
-
-    ConstNameDataPtr pNameData = std::make_shared< const NameData >( std::string(cstr), UINT64_MAX );
-    mData = pNameData;
-    mId = pNameData->id;
+    assert( nullptr != str );
+    assert( hash == pt::HashName( str, length ) );
+    assert( length <= UINT32_MAX );
+    Assign_( GetNameTable().Intern( str, static_cast<uint32_t>( length ), hash ) );
 }
 
 
 void pt::Name::
-Init_() const
+Assign_( const NameEntry* entry )
 {
-    if( IsInPreInitState_() ){
-        ConstNameDataPtr tempPtr = mData; // save a local pointer to prevent destruction
-        CreateSyncedState_( tempPtr->str.c_str(), tempPtr->str.length() );
-    }
-    assert( UINT64_MAX != mId );
+#ifdef PT_NAME_COMPACT
+    mId    = ( nullptr != entry ) ? static_cast<uint32_t>( entry->id ) : 0;
+#else
+    mEntry = entry;
+    mId    = ( nullptr != entry ) ? entry->id : 0;
+#endif
+}
+
+
+const pt::NameEntry* pt::Name::
+GetEntry_() const
+{
+#ifdef PT_NAME_COMPACT
+    return ( 0 != mId ) ? GetNameTable().FindById( mId ) : nullptr;
+#else
+    return mEntry;
+#endif
+}
+
+
+bool pt::
+operator==( const Name& name, const NameLiteral& literal )
+{
+    const NameEntry* entry = name.GetEntry_();
+    return ( nullptr != entry )
+        && ( literal.GetHash() == entry->hash )
+        && ( literal.length() == entry->length )
+        && ( 0 == memcmp( literal.c_str(), entry->GetChars(), literal.length() ) );
 }
 
 
 std::ostream&
 operator<<( std::ostream& os, const pt::Name& obj )
 {
-    os << obj.GetStdString();
+    os.write( obj.c_str(), obj.length() );
     return os;
 }
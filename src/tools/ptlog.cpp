@@ -0,0 +1,683 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    ptlog.cpp
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Log file query tool.
+  *            Memory-maps the log files and splits them into lines with SSE2 (16 bytes per step),
+  *            substring searches jump between matches with 'memmem()' instead of visiting every line.
+  *            Compressed rotated files ('.lz') are decompressed into memory.
+  *          Understands the line layouts written by ptlib:
+  *            "<timestamp> <prefix>: <text>", "<prefix>: <text>" (timestamps disabled),
+  *            and JSON lines of key-value records ({"time":"<timestamp>","stream":"<prefix>",...}).
+  *            Lines without a header (multi-line messages) belong to the record before them.
+  *          Filters are combined (all of them have to match):
+  *            level=<prefix,...>       stream prefixes, eg.: level=Warning,ERROR ("Log" is the info stream)
+  *            from=<timestamp>         records at or after, eg.: from="2026-10-18 07:00"
+  *            to=<timestamp>           records at or before, partial timestamps include the whole period
+  *                                       eg.: to="2026-10-18 07" includes 07:59:59.999
+  *            contains=<text>          records containing 'text' (case-sensitive)
+  *          Time index:
+  *            'index' builds (or refreshes) a sidecar file '<log_file>.ptidx' holding the file offset of the
+  *            first record of every 256KB, queries with 'from=' then seek directly to the right region.
+  *            The index stays usable, while the log file is appended to (the new part is scanned).
+  *            The scan stops, when a record is more than a second past 'to=' (records can be slightly out of order).
+  * USAGE:   ptlib_log <log_file>... [level=<prefix,...>] [from=<timestamp>] [to=<timestamp>]
+  *                                  [contains=<text>] [count] [index]
+  *            count:   print only the number of matching lines
+  *            eg.: ptlib_log ./log/all.txt level=ERROR from="2026-10-18 07:00" contains=timeout
+  *          The executable is called 'ptlib_log' (not 'ptlog'), like the other binaries of the project
+  *            ('ptlib_logd', 'ptlib_bench_*'), so it can't clash with unrelated tools on the PATH.
+  * -----------------------------------------------------------------------------
+  */
+
+#include "pt/log/compress.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace{
+
+const size_t    gTimestampLength   = 23;            // "YYYY-MM-DD HH:MM:SS.mmm"
+const size_t    gMaxPrefixLength   = 32;
+const size_t    gMaxContinuationLines = 256;
+const uint64_t  gIndexStride       = 256 * 1024;
+const char      gIndexMagic[8]     = { 'P', 'T', 'L', 'O', 'G', 'I', 'X', '1' };
+const char*     gIndexExtension    = ".ptidx";
+const char*     gKnownPrefixes[]   = { "Debug", "Log", "Warning", "ERROR" };
+const char      gJsonHeader[]      = "{\"time\":\"";
+const char      gJsonStream[]      = "\",\"stream\":\"";
+
+
+struct Query{
+    std::vector<std::string>    levels;
+    std::string                 from;
+    std::string                 to;
+    std::string                 contains;
+    bool                        countOnly  = false;
+    bool                        buildIndex = false;
+
+    bool HasTimeFilter() const{
+        return ( 0 < from.length() ) || ( 0 < to.length() );
+    }
+};
+
+
+struct IndexHeader{
+    char        magic[8];
+    uint64_t    indexedSize;            // length of the log file, when the index was built
+    uint64_t    entryCount;
+    char        fileStart[32];          // first bytes of the log file, detects replaced (rotated) files
+};
+
+struct IndexEntry{
+    uint64_t    offset;
+    char        timestamp[24];          // not terminated
+};
+
+
+// header of the record a line belongs to
+struct RecordInfo{
+    const char* timestamp = nullptr;    // 'gTimestampLength' characters, null if unknown
+    const char* prefix    = nullptr;
+    size_t      prefixLength = 0;
+};
+
+
+//-----
+// file contents
+
+class LogData
+{
+public:
+    ~LogData(){
+        if( nullptr != mMapping ){
+            munmap( mMapping, mLength );
+        }
+    }
+
+    bool Load( const std::string& path ){
+        const std::string extension = pt::log::CompressedFileExtension;
+        if( (extension.length() < path.length())
+            && (0 == path.compare( path.length() - extension.length(), extension.length(), extension )) )
+        {
+            return LoadCompressed_( path );
+        }
+
+        int fd = open( path.c_str(), O_RDONLY );
+        if( fd < 0 ){
+            std::cerr << "ptlib_log: can't open '" << path << "'\n";
+            return false;
+        }
+        struct stat file_stat;
+        if( (0 != fstat( fd, &file_stat )) ){
+            close( fd );
+            return false;
+        }
+        mLength = file_stat.st_size;
+        if( 0 < mLength ){
+            mMapping = mmap( nullptr, mLength, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if( MAP_FAILED == mMapping ){
+                mMapping = nullptr;
+                close( fd );
+                std::cerr << "ptlib_log: can't map '" << path << "'\n";
+                return false;
+            }
+            madvise( mMapping, mLength, MADV_SEQUENTIAL );
+        }
+        close( fd );
+        mIndexable = true;
+        return true;
+    }
+
+    const char* Begin() const{
+        return ( nullptr != mMapping ) ? static_cast<const char*>( mMapping ) : mDecompressed.data();
+    }
+
+    const char* End() const{
+        return Begin() + mLength;
+    }
+
+    size_t Length() const{
+        return mLength;
+    }
+
+    // only files on disk can have an index
+    bool IsIndexable() const{
+        return mIndexable;
+    }
+
+private:
+    bool LoadCompressed_( const std::string& path ){
+        FILE* file = fopen( path.c_str(), "rb" );
+        if( nullptr == file ){
+            std::cerr << "ptlib_log: can't open '" << path << "'\n";
+            return false;
+        }
+        std::string compressed;
+        char buffer[64 * 1024];
+        size_t count;
+        while( 0 < ( count = fread( buffer, 1, sizeof(buffer), file ) ) ){
+            compressed.append( buffer, count );
+        }
+        fclose( file );
+
+        if( !pt::log::Decompress( compressed.data(), compressed.length(), mDecompressed ) ){
+            std::cerr << "ptlib_log: '" << path << "' is not a valid compressed log file\n";
+            return false;
+        }
+        mLength = mDecompressed.length();
+        return true;
+    }
+
+    void*       mMapping = nullptr;
+    size_t      mLength  = 0;
+    std::string mDecompressed;
+    bool        mIndexable = false;
+};
+
+
+//-----
+// line parsing
+
+const char*
+FindNewline( const char* pos, const char* end )
+{
+    #ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8( '\n' );
+    while( pos + 16 <= end ){
+        const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pos ) );
+        const int     mask  = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, newline ) );
+        if( 0 != mask ){
+            return pos + __builtin_ctz( mask );
+        }
+        pos += 16;
+    }
+    #endif
+    const void* found = memchr( pos, '\n', end - pos );
+    return ( nullptr != found ) ? static_cast<const char*>( found ) : end;
+}
+
+
+const char*
+FindLineStart( const char* begin, const char* pos )
+{
+    const void* found = memrchr( begin, '\n', pos - begin );
+    return ( nullptr != found ) ? static_cast<const char*>( found ) + 1 : begin;
+}
+
+
+bool
+IsTimestamp( const char* str, size_t length )
+{
+    return ( gTimestampLength <= length )
+           && ( '-' == str[4] ) && ( '-' == str[7] ) && ( ' ' == str[10] )
+           && ( ':' == str[13] ) && ( ':' == str[16] ) && ( '.' == str[19] )
+           && isdigit( static_cast<unsigned char>( str[0] ) )
+           && isdigit( static_cast<unsigned char>( str[22] ) );
+}
+
+
+// returns the length of the prefix, if 'line' starts with "<prefix>: ", 0 otherwise
+size_t
+FindPrefix( const char* line, size_t length )
+{
+    const size_t limit = std::min( length, gMaxPrefixLength );
+    for( size_t i=0; i+1<limit; ++i ){
+        if( (':' == line[i]) && (' ' == line[i+1]) ){
+            return i;
+        }
+    }
+    return 0;
+}
+
+
+bool
+IsKnownPrefix( const char* prefix, size_t length )
+{
+    for( const char* known : gKnownPrefixes ){
+        if( (strlen( known ) == length) && (0 == memcmp( known, prefix, length )) ){
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// returns false for continuation lines (the record header is left untouched then)
+bool
+ParseHeader( const char* line, size_t length, RecordInfo& info )
+{
+    if( IsTimestamp( line, length ) ){
+        info.timestamp    = line;
+        info.prefix       = line + gTimestampLength + 1;
+        info.prefixLength = ( gTimestampLength + 1 < length )
+                            ? FindPrefix( info.prefix, length - gTimestampLength - 1 ) : 0;
+        return true;
+    }
+
+    const size_t json_header_length = sizeof(gJsonHeader) - 1;
+    const size_t json_stream_length = sizeof(gJsonStream) - 1;
+    if( (json_header_length + gTimestampLength + json_stream_length < length)
+        && (0 == memcmp( line, gJsonHeader, json_header_length ))
+        && IsTimestamp( line + json_header_length, length - json_header_length ) )
+    {
+        info.timestamp = line + json_header_length;
+        info.prefix    = info.timestamp + gTimestampLength + json_stream_length;
+        const void* end = memchr( info.prefix, '"', line + length - info.prefix );
+        info.prefixLength = ( nullptr != end ) ? static_cast<const char*>( end ) - info.prefix : 0;
+        return true;
+    }
+
+    const size_t prefix_length = FindPrefix( line, length );
+    if( (0 < prefix_length) && IsKnownPrefix( line, prefix_length ) ){
+        info.timestamp    = nullptr;
+        info.prefix       = line;
+        info.prefixLength = prefix_length;
+        return true;
+    }
+    return false;
+}
+
+
+// compares the first 'bound.length()' characters (partial timestamps cover a whole period)
+int
+CompareTimestamp( const char* timestamp, const std::string& bound )
+{
+    return strncmp( timestamp, bound.c_str(), std::min( bound.length(), gTimestampLength ) );
+}
+
+
+// the timestamp of 'bound' plus one second, for the early stop of the scan
+//   an increment of the seconds digits is enough, the result is only compared
+std::string
+GetStopTimestamp( const std::string& bound )
+{
+    std::string stop = bound;
+    if( stop.length() < 19 ){
+        stop.resize( 19, '9' );     // partial bound: stop after the whole period
+    }
+    stop.resize( 19 );
+    for( size_t i=18; 0 < i; --i ){
+        if( !isdigit( static_cast<unsigned char>( stop[i] ) ) ){
+            continue;
+        }
+        if( '9' != stop[i] ){
+            ++stop[i];
+            return stop;
+        }
+        stop[i] = '0';
+    }
+    return std::string( gTimestampLength, '9' );
+}
+
+
+//-----
+// filtering
+
+class Matcher
+{
+public:
+    explicit Matcher( const Query& query ):
+        mQuery( query ),
+        mStop( query.to.empty() ? std::string() : GetStopTimestamp( query.to ) )
+    {}
+
+    bool Matches( const RecordInfo& info, const char* line, size_t length ) const{
+        if( mQuery.HasTimeFilter() ){
+            if( nullptr == info.timestamp ){
+                return false;
+            }
+            if( (0 < mQuery.from.length()) && (CompareTimestamp( info.timestamp, mQuery.from ) < 0) ){
+                return false;
+            }
+            if( (0 < mQuery.to.length()) && (0 < CompareTimestamp( info.timestamp, mQuery.to )) ){
+                return false;
+            }
+        }
+        if( !mQuery.levels.empty() ){
+            bool found = false;
+            for( const auto& level : mQuery.levels ){
+                found |= ( level.length() == info.prefixLength )
+                         && ( 0 == memcmp( level.data(), info.prefix, info.prefixLength ) );
+            }
+            if( !found ){
+                return false;
+            }
+        }
+        return mQuery.contains.empty()
+               || ( nullptr != memmem( line, length, mQuery.contains.data(), mQuery.contains.length() ) );
+    }
+
+    bool IsPastEnd( const RecordInfo& info ) const{
+        return ( 0 < mStop.length() ) && ( nullptr != info.timestamp )
+               && ( 0 < CompareTimestamp( info.timestamp, mStop ) );
+    }
+
+private:
+    const Query&        mQuery;
+    const std::string   mStop;
+};
+
+
+class Output
+{
+public:
+    Output( const std::string& label, bool count_only ):
+        mLabel( label ), mCountOnly( count_only )
+    {}
+
+    void Line( const char* line, size_t length ){
+        ++mCount;
+        if( mCountOnly ){
+            return;
+        }
+        if( 0 < mLabel.length() ){
+            fwrite( mLabel.data(), 1, mLabel.length(), stdout );
+            fputc( ':', stdout );
+        }
+        fwrite( line, 1, length, stdout );
+        fputc( '\n', stdout );
+    }
+
+    uint64_t GetCount() const{
+        return mCount;
+    }
+
+private:
+    const std::string   mLabel;
+    const bool          mCountOnly;
+    uint64_t            mCount = 0;
+};
+
+
+// finds the header of the record, that 'line_start' belongs to
+//   gives up after 'gMaxContinuationLines' lines without a header
+RecordInfo
+FindRecordInfo( const char* begin, const char* end, const char* line_start )
+{
+    RecordInfo  info;
+    const char* pos = line_start;
+    for( size_t i=0; i<gMaxContinuationLines; ++i ){
+        const char* line_end = FindNewline( pos, end );
+        if( ParseHeader( pos, line_end - pos, info ) || (pos == begin) ){
+            break;
+        }
+        pos = FindLineStart( begin, pos - 1 );
+    }
+    return info;
+}
+
+
+void
+ScanLines( const char* begin, const char* start, const char* end,
+           const Matcher& matcher, Output& output )
+{
+    RecordInfo info = ( start == begin ) ? RecordInfo() : FindRecordInfo( begin, end, start );
+    const char* pos = start;
+    while( pos < end ){
+        const char* line_end = FindNewline( pos, end );
+        const size_t length = line_end - pos;
+        ParseHeader( pos, length, info );
+        if( matcher.IsPastEnd( info ) ){
+            return;
+        }
+        if( matcher.Matches( info, pos, length ) ){
+            output.Line( pos, length );
+        }
+        pos = line_end + 1;
+    }
+}
+
+
+// jumps from match to match of the substring, only the matching lines are parsed
+void
+ScanMatches( const char* begin, const char* start, const char* end,
+             const std::string& needle, const Matcher& matcher, Output& output )
+{
+    const char* pos = start;
+    while( pos < end ){
+        const void* found = memmem( pos, end - pos, needle.data(), needle.length() );
+        if( nullptr == found ){
+            return;
+        }
+        const char* line_start = FindLineStart( std::max( begin, start ),
+                                                static_cast<const char*>( found ) );
+        const char* line_end   = FindNewline( static_cast<const char*>( found ), end );
+        const RecordInfo info  = FindRecordInfo( begin, end, line_start );
+        if( matcher.IsPastEnd( info ) ){
+            return;
+        }
+        if( matcher.Matches( info, line_start, line_end - line_start ) ){
+            output.Line( line_start, line_end - line_start );
+        }
+        pos = line_end + 1;
+    }
+}
+
+
+//-----
+// index
+
+std::string
+GetIndexPath( const std::string& path )
+{
+    return path + gIndexExtension;
+}
+
+
+void
+FillFileStart( const LogData& data, char* out )
+{
+    memset( out, 0, sizeof(IndexHeader::fileStart) );
+    memcpy( out, data.Begin(), std::min( data.Length(), sizeof(IndexHeader::fileStart) ) );
+}
+
+
+bool
+BuildIndex( const std::string& path, const LogData& data )
+{
+    std::vector<IndexEntry> entries;
+    const char* begin = data.Begin();
+    const char* end   = data.End();
+    uint64_t    next_offset = 0;
+    const char* pos = begin;
+    while( pos < end ){
+        const char* line_end = FindNewline( pos, end );
+        RecordInfo info;
+        if( (next_offset <= static_cast<uint64_t>( pos - begin ))
+            && ParseHeader( pos, line_end - pos, info ) && (nullptr != info.timestamp) )
+        {
+            IndexEntry entry;
+            entry.offset = pos - begin;
+            memset( entry.timestamp, 0, sizeof(entry.timestamp) );
+            memcpy( entry.timestamp, info.timestamp, gTimestampLength );
+            entries.push_back( entry );
+            next_offset = entry.offset + gIndexStride;
+            // skip to the stride boundary
+            if( begin + next_offset < end ){
+                pos = FindLineStart( begin, begin + next_offset );
+                continue;
+            }
+            break;
+        }
+        pos = line_end + 1;
+    }
+
+    IndexHeader header;
+    memcpy( header.magic, gIndexMagic, sizeof(header.magic) );
+    header.indexedSize = data.Length();
+    header.entryCount  = entries.size();
+    FillFileStart( data, header.fileStart );
+
+    const std::string index_path = GetIndexPath( path );
+    FILE* file = fopen( index_path.c_str(), "wb" );
+    if( nullptr == file ){
+        std::cerr << "ptlib_log: can't write '" << index_path << "'\n";
+        return false;
+    }
+    bool success = ( 1 == fwrite( &header, sizeof(header), 1, file ) );
+    if( !entries.empty() ){
+        success &= ( entries.size() == fwrite( entries.data(), sizeof(IndexEntry), entries.size(), file ) );
+    }
+    success &= ( 0 == fclose( file ) );
+    std::cerr << "ptlib_log: indexed '" << path << "' (" << entries.size() << " entries)\n";
+    return success;
+}
+
+
+// returns the offset to start scanning from for 'from', 0 without a usable index
+uint64_t
+FindStartOffset( const std::string& path, const LogData& data, const std::string& from )
+{
+    FILE* file = fopen( GetIndexPath( path ).c_str(), "rb" );
+    if( nullptr == file ){
+        return 0;
+    }
+    IndexHeader header;
+    std::vector<IndexEntry> entries;
+    char file_start[sizeof(header.fileStart)];
+    FillFileStart( data, file_start );
+    if( (1 == fread( &header, sizeof(header), 1, file ))
+        && (0 == memcmp( header.magic, gIndexMagic, sizeof(header.magic) ))
+        && (header.indexedSize <= data.Length())
+        && (0 == memcmp( header.fileStart, file_start, sizeof(file_start) )) )
+    {
+        entries.resize( header.entryCount );
+        if( entries.size() != fread( entries.data(), sizeof(IndexEntry), entries.size(), file ) ){
+            entries.clear();
+        }
+    }
+    fclose( file );
+
+    // the last entry before 'from', one more step back for slightly out of order records
+    auto it = std::lower_bound( entries.begin(), entries.end(), from,
+                                []( const IndexEntry& entry, const std::string& bound ){
+                                    return CompareTimestamp( entry.timestamp, bound ) < 0;
+                                } );
+    const size_t steps_back = 2;
+    if( static_cast<size_t>( it - entries.begin() ) <= steps_back ){
+        return 0;
+    }
+    return ( it - steps_back )->offset;
+}
+
+
+//-----
+
+bool
+ParseArgument( const std::string& arg, Query& query )
+{
+    auto value_of = [&arg]( const char* key, std::string& value ){
+        const size_t key_length = strlen( key );
+        if( 0 != arg.compare( 0, key_length, key ) ){
+            return false;
+        }
+        value = arg.substr( key_length );
+        return true;
+    };
+
+    std::string levels;
+    if( value_of( "level=", levels ) ){
+        size_t start = 0;
+        while( start <= levels.length() ){
+            size_t comma = levels.find( ',', start );
+            if( std::string::npos == comma ){
+                comma = levels.length();
+            }
+            if( start < comma ){
+                query.levels.push_back( levels.substr( start, comma - start ) );
+            }
+            start = comma + 1;
+        }
+        return true;
+    }
+    if( value_of( "from=", query.from ) || value_of( "to=", query.to ) || value_of( "contains=", query.contains ) ){
+        return true;
+    }
+    if( "count" == arg ){
+        query.countOnly = true;
+        return true;
+    }
+    if( "index" == arg ){
+        query.buildIndex = true;
+        return true;
+    }
+    return false;
+}
+
+
+} //end of anonymous namespace
+
+
+int
+main( int argc, char** argv )
+{
+    Query query;
+    std::vector<std::string> paths;
+    for( int i=1; i<argc; ++i ){
+        const std::string arg = argv[i];
+        if( std::string::npos == arg.find( '=' ) && ("count" != arg) && ("index" != arg) ){
+            paths.push_back( arg );
+        }else if( !ParseArgument( arg, query ) ){
+            std::cerr << "unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if( paths.empty() ){
+        std::cout << "usage: " << argv[0] << " <log_file>... [level=<prefix,...>] [from=<timestamp>] [to=<timestamp>]"
+                  << " [contains=<text>] [count] [index]\n";
+        return 1;
+    }
+
+    static char output_buffer[1024 * 1024];
+    setvbuf( stdout, output_buffer, _IOFBF, sizeof(output_buffer) );
+
+    const Matcher matcher( query );
+    uint64_t total = 0;
+    bool success = true;
+    for( const auto& path : paths ){
+        LogData data;
+        if( !data.Load( path ) ){
+            success = false;
+            continue;
+        }
+        if( query.buildIndex ){
+            if( data.IsIndexable() ){
+                success &= BuildIndex( path, data );
+            }
+            continue;
+        }
+
+        const uint64_t start_offset = ( data.IsIndexable() && (0 < query.from.length()) )
+                                      ? FindStartOffset( path, data, query.from ) : 0;
+        Output output( (1 < paths.size()) ? path : std::string(), query.countOnly );
+        const char* begin = data.Begin();
+        if( query.contains.empty() ){
+            ScanLines( begin, begin + start_offset, data.End(), matcher, output );
+        }else{
+            ScanMatches( begin, begin + start_offset, data.End(), query.contains, matcher, output );
+        }
+        total += output.GetCount();
+    }
+
+    if( query.countOnly && !query.buildIndex ){
+        fprintf( stdout, "%llu\n", static_cast<unsigned long long>( total ) );
+    }
+    fflush( stdout );
+    return success ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/** -----------------------------------------------------------------------------
+  * FILE:    ptlogd.cpp
+  * AUTHOR:  ptoth
+  * EMAIL:   peter.t.toth92@gmail.com
+  * PURPOSE: Logger daemon for multiprocess logging.
+  *            Creates the shared memory ring, that client processes attach to
+  *            (see 'pt::log::SetDaemonName()') and drains it into a log file.
+  *          Runs until SIGINT or SIGTERM, then writes out every pending record.
+  * USAGE:   ptlib_logd <shm_name> <log_file> [ring_capacity_bytes] [options]
+  *            options (see 'pt/log/rotation.h'):
+  *              rotate_bytes=<N>     rotate the log file when it exceeds N bytes
+  *              rotate_seconds=<N>   rotate the log file every N seconds
+  *              keep=<N>             keep only the last N rotated files
+  *              compress             compress the rotated files
+  *            eg.: ptlib_logd /ptlib_log ./log/all.txt 8388608 rotate_bytes=104857600 keep=10 compress
+  * -----------------------------------------------------------------------------
+  */
+
+#include "pt/log/filesink.h"
+#include "pt/log/shmring.h"
+
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static volatile std::sig_atomic_t gStopRequested = 0;
+
+// records consumed before the heartbeat is refreshed again
+static const size_t     gMaxBatchSize = 1024;
+static const uint32_t   gIdleWaitMs   = 100;
+
+
+static void
+HandleStopSignal( int signal )
+{
+    gStopRequested = 1;
+}
+
+
+static bool
+ParseOption( const std::string& option, pt::log::RotationSettings& rotation )
+{
+    auto value_of = [&option]( const char* key, uint64_t& value ){
+        const size_t key_length = strlen( key );
+        if( 0 != option.compare( 0, key_length, key ) ){
+            return false;
+        }
+        value = std::strtoull( option.c_str() + key_length, nullptr, 10 );
+        return true;
+    };
+
+    uint64_t value = 0;
+    if( value_of( "rotate_bytes=", value ) ){
+        rotation.maxFileSize = value;
+    }else if( value_of( "rotate_seconds=", value ) ){
+        rotation.intervalSeconds = static_cast<uint32_t>( value );
+    }else if( value_of( "keep=", value ) ){
+        rotation.maxRotatedFiles = static_cast<uint32_t>( value );
+    }else if( "compress" == option ){
+        rotation.compress = true;
+    }else{
+        return false;
+    }
+    return true;
+}
+
+
+int
+main( int argc, char** argv )
+{
+    if( argc < 3 ){
+        std::cout << "usage: " << argv[0] << " <shm_name> <log_file> [ring_capacity_bytes]"
+                  << " [rotate_bytes=<N>] [rotate_seconds=<N>] [keep=<N>] [compress]\n";
+        return 1;
+    }
+
+    const std::string shm_name = argv[1];
+    const std::string log_file = argv[2];
+    uint64_t capacity = pt::log::SharedMemoryRing::DefaultCapacity;
+    pt::log::RotationSettings rotation;
+    for( int i=3; i<argc; ++i ){
+        if( (3 == i) && isdigit( argv[i][0] ) ){
+            capacity = std::strtoull( argv[i], nullptr, 10 );
+        }else if( !ParseOption( argv[i], rotation ) ){
+            std::cout << "unknown option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    std::signal( SIGINT,  HandleStopSignal );
+    std::signal( SIGTERM, HandleStopSignal );
+
+    pt::log::FileSink sink;
+    sink.SetRotation( rotation );
+    if( !sink.Open( log_file ) ){
+        return 1;
+    }
+
+    pt::log::SharedMemoryRing ring;
+    if( !ring.Create( shm_name, capacity ) ){
+        return 1;
+    }
+    std::cout << "ptlib_logd: serving '" << shm_name << "' into '" << log_file << "'\n";
+
+    auto write_record = [&sink]( const char* data, size_t length ){
+        sink.Write( data, length );
+    };
+
+    while( !gStopRequested ){
+        ring.UpdateHeartbeat();
+        if( 0 == ring.Consume( write_record, gMaxBatchSize ) ){
+            // idle, make the written data visible before sleeping
+            sink.Flush();
+            ring.Wait( gIdleWaitMs );
+        }
+    }
+
+    while( 0 < ring.Consume( write_record, gMaxBatchSize ) ){}
+    sink.Close();
+    ring.Close();
+    return 0;
+}